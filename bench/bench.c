@@ -0,0 +1,139 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct BenchScenario
+{
+    const char *name;
+    int (*run)(int argc, char **argv);
+} BenchScenario;
+
+static const BenchScenario scenarios[] = {
+    {"physics", BenchPhysics},
+    {"sprites", BenchSprites},
+    {"snapshot", BenchSnapshot},
+    {"pacer", BenchPacer},
+    {"assets", BenchAssets},
+    {"stream", BenchStream},
+    {"tiles", BenchTiles},
+};
+
+const char *BenchArg(int argc, char **argv, const char *name)
+{
+    for (int i = 0; i + 1 < argc; ++i)
+    {
+        if (strcmp(argv[i], name) == 0)
+        {
+            return argv[i + 1];
+        }
+    }
+
+    return NULL;
+}
+
+int BenchArgInt(int argc, char **argv, const char *name, int defaultValue)
+{
+    const char *value = BenchArg(argc, argv, name);
+    return value != NULL ? atoi(value) : defaultValue;
+}
+
+double BenchArgDouble(int argc, char **argv, const char *name, double defaultValue)
+{
+    const char *value = BenchArg(argc, argv, name);
+    return value != NULL ? atof(value) : defaultValue;
+}
+
+int BenchArgIntList(int argc, char **argv, const char *name, int *values, int capacity)
+{
+    const char *value = BenchArg(argc, argv, name);
+    int count = 0;
+    while (value != NULL && *value != '\0' && count < capacity)
+    {
+        char *end = NULL;
+        values[count++] = (int)strtol(value, &end, 10);
+        value = (end != NULL && *end == ',') ? end + 1 : NULL;
+    }
+
+    return count;
+}
+
+bool BenchHasFlag(int argc, char **argv, const char *name)
+{
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(argv[i], name) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int CompareDoubles(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+double BenchPercentile(double *samples, int count, double percentile)
+{
+    if (count <= 0)
+    {
+        return 0.0;
+    }
+
+    qsort(samples, (size_t)count, sizeof(double), CompareDoubles);
+
+    // Nearest rank
+    int rank = (int)(percentile / 100.0 * count + 0.5);
+    rank = rank < 1 ? 1 : (rank > count ? count : rank);
+    return samples[rank - 1];
+}
+
+static void PrintUsage(void)
+{
+    fprintf(stderr, "usage: raylib_template_bench [scenario] [--option value ...]\nscenarios:");
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); ++i)
+    {
+        fprintf(stderr, " %s", scenarios[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+    // The scenario name is optional and defaults to the first entry
+    const BenchScenario *scenario = &scenarios[0];
+    if (argc > 1 && strncmp(argv[1], "--", 2) != 0)
+    {
+        scenario = NULL;
+        for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); ++i)
+        {
+            if (strcmp(argv[1], scenarios[i].name) == 0)
+            {
+                scenario = &scenarios[i];
+            }
+        }
+
+        if (scenario == NULL)
+        {
+            PrintUsage();
+            return 1;
+        }
+
+        argc -= 1;
+        argv += 1;
+    }
+
+    if (BenchHasFlag(argc, argv, "--help"))
+    {
+        PrintUsage();
+        return 0;
+    }
+
+    return scenario->run(argc, argv);
+}
@@ -0,0 +1,30 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+
+// Each scenario parses its own arguments and prints one JSON object per run to stdout
+int BenchPhysics(int argc, char **argv);
+int BenchPacer(int argc, char **argv);
+int BenchAssets(int argc, char **argv);
+int BenchStream(int argc, char **argv);
+int BenchTiles(int argc, char **argv);
+
+// Returns non-zero when a batched quad differs from the DrawTextureEx reference
+int BenchSprites(int argc, char **argv);
+
+// Returns non-zero when an interpolated pose falls outside its physics step
+int BenchSnapshot(int argc, char **argv);
+
+// Returns the value following a "--name value" pair, or NULL when absent
+const char *BenchArg(int argc, char **argv, const char *name);
+int BenchArgInt(int argc, char **argv, const char *name, int defaultValue);
+double BenchArgDouble(int argc, char **argv, const char *name, double defaultValue);
+// Parses a comma separated list such as "1,2,4,8". Returns the number of values written.
+int BenchArgIntList(int argc, char **argv, const char *name, int *values, int capacity);
+bool BenchHasFlag(int argc, char **argv, const char *name);
+
+// Sorts samples in place and returns the requested percentile (0-100)
+double BenchPercentile(double *samples, int count, double percentile);
+
+#endif // BENCH_H
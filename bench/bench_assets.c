@@ -0,0 +1,190 @@
+#include "assetpack.h"
+#include "bench.h"
+#include "timer.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef BENCH_ASSETS_DIR
+#define BENCH_ASSETS_DIR "assets/"
+#endif
+
+#ifndef BENCH_ASSET_PACK
+#define BENCH_ASSET_PACK "assets.pak"
+#endif
+
+// Reads every byte the way a texture upload would, so neither path skips its page faults
+static uint32_t ChecksumPixels(const uint8_t *pixels, size_t size)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i < size; i += 4)
+    {
+        sum += (uint32_t)pixels[i] | ((uint32_t)pixels[i + 1] << 8) |
+               ((uint32_t)pixels[i + 2] << 16) | ((uint32_t)pixels[i + 3] << 24);
+    }
+
+    return sum;
+}
+
+static unsigned char *ReadFile(const char *path, int *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = length > 0 ? malloc((size_t)length) : NULL;
+    if (data != NULL && fread(data, 1, (size_t)length, file) != (size_t)length)
+    {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(file);
+    *size = (int)length;
+    return data;
+}
+
+// What the game did before cooking: read and decode one image file per sprite, as LoadImage does
+static bool LoadLoose(const char *directory,
+                      const AssetPack *pack,
+                      uint32_t *checksum,
+                      size_t *byteCount)
+{
+    for (int i = 0; i < pack->spriteCount; ++i)
+    {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s%s.png", directory, pack->sprites[i].name);
+
+        int fileSize = 0;
+        unsigned char *file = ReadFile(path, &fileSize);
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        unsigned char *pixels =
+            file != NULL ? stbi_load_from_memory(file, fileSize, &width, &height, &channels, 4)
+                         : NULL;
+        free(file);
+        if (pixels == NULL)
+        {
+            fprintf(stderr, "Could not decode %s\n", path);
+            return false;
+        }
+
+        size_t size = (size_t)width * (size_t)height * 4;
+        *checksum += ChecksumPixels(pixels, size);
+        *byteCount += size;
+        stbi_image_free(pixels);
+    }
+
+    return true;
+}
+
+static bool LoadPacked(const char *path, uint32_t *checksum, size_t *byteCount)
+{
+    AssetPack pack;
+    if (!OpenAssetPack(path, &pack))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < pack.pageCount; ++i)
+    {
+        size_t size = (size_t)pack.pages[i].dataSize;
+        *checksum += ChecksumPixels(GetAssetPagePixels(&pack, i), size);
+        *byteCount += size;
+    }
+
+    CloseAssetPack(&pack);
+    return true;
+}
+
+int BenchAssets(int argc, char **argv)
+{
+    const char *directory = BenchArg(argc, argv, "--dir");
+    const char *packPath = BenchArg(argc, argv, "--pack");
+    int iterationCount = BenchArgInt(argc, argv, "--iterations", 50);
+    directory = directory != NULL ? directory : BENCH_ASSETS_DIR;
+    packPath = packPath != NULL ? packPath : BENCH_ASSET_PACK;
+
+    if (iterationCount <= 0)
+    {
+        fprintf(stderr, "--iterations must be positive\n");
+        return 1;
+    }
+
+    // The pack's sprite names select which loose files to decode, so both paths load the same set
+    AssetPack pack;
+    if (!OpenAssetPack(packPath, &pack))
+    {
+        fprintf(stderr, "Could not open asset pack %s\n", packPath);
+        return 1;
+    }
+
+    double *looseMs = malloc(sizeof(double) * (size_t)iterationCount);
+    double *packedMs = malloc(sizeof(double) * (size_t)iterationCount);
+    uint32_t checksum = 0;
+    size_t looseBytes = 0;
+    size_t packedBytes = 0;
+    bool ok = true;
+
+    // Alternate the two paths so both see the same page cache and clock state
+    for (int i = 0; i < iterationCount && ok; ++i)
+    {
+        looseBytes = 0;
+        uint64_t start = TimerNow();
+        ok = LoadLoose(directory, &pack, &checksum, &looseBytes);
+        looseMs[i] = 1000.0 * TimerSeconds(start, TimerNow());
+
+        packedBytes = 0;
+        start = TimerNow();
+        ok = ok && LoadPacked(packPath, &checksum, &packedBytes);
+        packedMs[i] = 1000.0 * TimerSeconds(start, TimerNow());
+    }
+
+    if (ok)
+    {
+        double firstLoose = looseMs[0];
+        double firstPacked = packedMs[0];
+        double looseP50 = BenchPercentile(looseMs, iterationCount, 50.0);
+        double looseP99 = BenchPercentile(looseMs, iterationCount, 99.0);
+        double packedP50 = BenchPercentile(packedMs, iterationCount, 50.0);
+        double packedP99 = BenchPercentile(packedMs, iterationCount, 99.0);
+
+        printf("{\"scenario\":\"assets\",\"sprites\":%d,\"pages\":%d,\"iterations\":%d,"
+               "\"decodedBytes\":%zu,\"mappedBytes\":%zu,\"decodeFirstMs\":%.4f,"
+               "\"decodeP50Ms\":%.4f,\"decodeP99Ms\":%.4f,\"mmapFirstMs\":%.4f,\"mmapP50Ms\":%.4f,"
+               "\"mmapP99Ms\":%.4f,\"speedup\":%.1f,\"checksum\":%u}\n",
+               pack.spriteCount,
+               pack.pageCount,
+               iterationCount,
+               looseBytes,
+               packedBytes,
+               firstLoose,
+               looseP50,
+               looseP99,
+               firstPacked,
+               packedP50,
+               packedP99,
+               packedP50 > 0.0 ? looseP50 / packedP50 : 0.0,
+               checksum);
+    }
+    else
+    {
+        fprintf(stderr, "Loading failed\n");
+    }
+
+    free(looseMs);
+    free(packedMs);
+    CloseAssetPack(&pack);
+    return ok ? 0 : 1;
+}
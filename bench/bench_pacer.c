@@ -0,0 +1,171 @@
+#include "bench.h"
+#include "framepacer.h"
+#include "thread.h"
+#include "timer.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum PacerStrategy
+{
+    PACER_LEGACY, // the original fixed 1 ms WaitTime
+    PACER_SLEEP,
+    PACER_SPIN,
+    PACER_HYBRID,
+    PACER_STRATEGY_COUNT
+} PacerStrategy;
+
+static const char *strategyNames[PACER_STRATEGY_COUNT] = {"legacy", "sleep", "spin", "hybrid"};
+
+// Target rates used when no --fps is given. 1200 matches the game's maxFPS, a period shorter than
+// the sleep overshoot on many systems.
+static const int sweepFPS[] = {240, 1200};
+
+// Work per frame as a fraction of the period when no --work-ms is given
+#define DEFAULT_WORK_FRACTION 0.25
+
+// Busy work standing in for update and draw
+static void SimulateWork(uint64_t nanoseconds)
+{
+    uint64_t end = TimerNow() + nanoseconds;
+    while (TimerNow() < end)
+    {
+    }
+}
+
+static void RunPacer(PacerStrategy strategy, double fps, int frameCount, double workMs)
+{
+    FramePacerMode mode = FRAME_PACER_HYBRID;
+    if (strategy == PACER_SLEEP)
+    {
+        mode = FRAME_PACER_SLEEP;
+    }
+    else if (strategy == PACER_SPIN)
+    {
+        mode = FRAME_PACER_SPIN;
+    }
+
+    FramePacer pacer = MakeFramePacer(1.0 / fps, mode);
+    double *frameMs = malloc(sizeof(double) * (size_t)frameCount);
+    uint32_t state = 987654321u;
+
+    // One unmeasured frame starts the schedule
+    WaitForNextFrame(&pacer);
+
+    double cpuStart = TimerProcessCpuSeconds();
+    uint64_t wallStart = TimerNow();
+    uint64_t frameStart = wallStart;
+
+    for (int i = 0; i < frameCount; ++i)
+    {
+        // Work varies between 50% and 150% of the requested time
+        state = state * 1664525u + 1013904223u;
+        double jitter = 0.5 + (double)(state >> 8) / 16777216.0;
+        SimulateWork((uint64_t)(workMs * jitter * 1e6));
+
+        if (strategy == PACER_LEGACY)
+        {
+            TimerSleep(1000000ull);
+        }
+        else
+        {
+            WaitForNextFrame(&pacer);
+        }
+
+        uint64_t frameEnd = TimerNow();
+        frameMs[i] = 1000.0 * TimerSeconds(frameStart, frameEnd);
+        frameStart = frameEnd;
+    }
+
+    double wallSeconds = TimerSeconds(wallStart, TimerNow());
+    double cpuSeconds = TimerProcessCpuSeconds() - cpuStart;
+
+    double mean = 0.0;
+    for (int i = 0; i < frameCount; ++i)
+    {
+        mean += frameMs[i];
+    }
+    mean /= frameCount;
+
+    double variance = 0.0;
+    for (int i = 0; i < frameCount; ++i)
+    {
+        variance += (frameMs[i] - mean) * (frameMs[i] - mean);
+    }
+    variance /= frameCount;
+
+    printf("{\"scenario\":\"pacer\",\"strategy\":\"%s\",\"targetFPS\":%.1f,\"frames\":%d,"
+           "\"workMs\":%.2f,\"cpuPercent\":%.1f,\"meanFrameMs\":%.4f,\"stddevFrameMs\":%.4f,"
+           "\"p99FrameMs\":%.4f,\"missed\":%llu,\"sleepPercent\":%.1f,\"spinThresholdUs\":%.1f,"
+           "\"latenessHistogram\":[",
+           strategyNames[strategy],
+           fps,
+           frameCount,
+           workMs,
+           100.0 * cpuSeconds / wallSeconds,
+           mean,
+           sqrt(variance),
+           BenchPercentile(frameMs, frameCount, 99.0),
+           (unsigned long long)pacer.stats.missedDeadlines,
+           100.0 * pacer.stats.sleepSeconds / wallSeconds,
+           pacer.spinThreshold * 1e-3);
+    for (int i = 0; i < FRAME_PACER_HISTOGRAM_BUCKETS; ++i)
+    {
+        printf("%s%llu", i > 0 ? "," : "", (unsigned long long)pacer.stats.latenessHistogram[i]);
+    }
+    printf("]}\n");
+    fflush(stdout);
+
+    free(frameMs);
+}
+
+int BenchPacer(int argc, char **argv)
+{
+    int frameCount = BenchArgInt(argc, argv, "--frames", 600);
+    double workMs = BenchArgDouble(argc, argv, "--work-ms", 0.0);
+    const char *only = BenchArg(argc, argv, "--strategy");
+
+    int fpsList[16] = {0};
+    int fpsCount = BenchArgIntList(argc, argv, "--fps", fpsList, 16);
+    if (fpsCount == 0)
+    {
+        fpsCount = (int)(sizeof(sweepFPS) / sizeof(sweepFPS[0]));
+        for (int i = 0; i < fpsCount; ++i)
+        {
+            fpsList[i] = sweepFPS[i];
+        }
+    }
+
+    for (int i = 0; i < fpsCount; ++i)
+    {
+        if (fpsList[i] <= 0)
+        {
+            fprintf(stderr, "--fps values must be positive\n");
+            return 1;
+        }
+    }
+
+    if (frameCount <= 0)
+    {
+        fprintf(stderr, "--frames must be positive\n");
+        return 1;
+    }
+
+    for (int f = 0; f < fpsCount; ++f)
+    {
+        double fps = (double)fpsList[f];
+        double frameWorkMs = workMs > 0.0 ? workMs : DEFAULT_WORK_FRACTION * 1000.0 / fps;
+        for (int i = 0; i < PACER_STRATEGY_COUNT; ++i)
+        {
+            if (only == NULL || strcmp(only, strategyNames[i]) == 0)
+            {
+                RunPacer((PacerStrategy)i, fps, frameCount, frameWorkMs);
+            }
+        }
+    }
+
+    return 0;
+}
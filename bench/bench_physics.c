@@ -0,0 +1,182 @@
+#include "bench.h"
+#include "entities.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "scene.h"
+#include "timer.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Box counts used when no --boxes is given
+static const int sweepBoxCounts[] = {4, 256, 1024, 4096, 16384, 32768};
+
+static void RunPhysics(const SceneDef *def,
+                       int workerCount,
+                       float fixedFPS,
+                       int subStepCount,
+                       int warmupCount,
+                       int stepCount)
+{
+    JobSystem *jobSystem = JobSystemCreate(workerCount);
+
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    JobSystemConfigureWorld(jobSystem, &worldDef);
+    Scene scene = CreateScene(&worldDef, def);
+    FixedStep fixedStep = MakeFixedStep(fixedFPS, subStepCount);
+
+    EntityStore entities = CreateEntityStore(scene.groundCount + scene.boxCount);
+    for (int i = 0; i < scene.groundCount; ++i)
+    {
+        CreateEntity(&entities, scene.groundBodies[i], 0);
+    }
+    for (int i = 0; i < scene.boxCount; ++i)
+    {
+        CreateEntity(&entities, scene.boxBodies[i], 1);
+    }
+
+    double *stepMs = malloc(sizeof(double) * (size_t)stepCount);
+    double *transformMs = malloc(sizeof(double) * (size_t)stepCount);
+    long long moveSum = 0;
+    double totalSeconds = 0.0;
+    long long contactSum = 0;
+    int contactMax = 0;
+
+    int stepIndex = 0;
+    while (stepIndex < warmupCount + stepCount)
+    {
+        // Feed one fixed step worth of frame time, as the game does when it keeps up
+        FixedStepAdvance(&fixedStep, fixedStep.fixedTimeStep);
+
+        while (FixedStepConsume(&fixedStep))
+        {
+            PROFILE_ZONE_BEGIN(stepZone, "b2World_Step");
+            uint64_t start = TimerNow();
+            b2World_Step(scene.worldId, (float)fixedStep.fixedTimeStep, fixedStep.subStepCount);
+            uint64_t end = TimerNow();
+            PROFILE_ZONE_END(stepZone);
+            PROFILE_BOX2D_STEP(stepZone, scene.worldId);
+
+            PROFILE_ZONE_BEGIN(transformZone, "entity transform");
+            b2BodyEvents events = b2World_GetBodyEvents(scene.worldId);
+            ApplyBodyMoveEvents(&entities, events);
+            uint64_t transformEnd = TimerNow();
+            PROFILE_ZONE_END(transformZone);
+
+            if (stepIndex >= warmupCount)
+            {
+                double seconds = TimerSeconds(start, end);
+                stepMs[stepIndex - warmupCount] = 1000.0 * seconds;
+                transformMs[stepIndex - warmupCount] = 1000.0 * TimerSeconds(end, transformEnd);
+                totalSeconds += seconds;
+                moveSum += events.moveCount;
+
+                b2Counters counters = b2World_GetCounters(scene.worldId);
+                contactSum += counters.contactCount;
+                if (counters.contactCount > contactMax)
+                {
+                    contactMax = counters.contactCount;
+                }
+            }
+
+            ++stepIndex;
+        }
+    }
+
+    double budgetMs = 1000.0 * fixedStep.fixedTimeStep;
+    double stepsPerSecond = totalSeconds > 0.0 ? stepCount / totalSeconds : 0.0;
+    double p50 = BenchPercentile(stepMs, stepCount, 50.0);
+    double p99 = BenchPercentile(stepMs, stepCount, 99.0);
+    double maxMs = stepMs[stepCount - 1];
+    double transformP50 = BenchPercentile(transformMs, stepCount, 50.0);
+
+    printf("{\"scenario\":\"physics\",\"workers\":%d,\"boxes\":%d,\"ground\":%d,\"bodies\":%d,"
+           "\"steps\":%d,\"fixedFPS\":%.1f,\"subSteps\":%d,\"stepsPerSecond\":%.1f,\"p50Ms\":%.4f,"
+           "\"p99Ms\":%.4f,\"maxMs\":%.4f,\"meanContacts\":%.1f,\"maxContacts\":%d,"
+           "\"meanMoveEvents\":%.1f,\"transformP50Ms\":%.4f,\"realtimeFactor\":%.3f,"
+           "\"keepsUp\":%s}\n",
+           JobSystemGetWorkerCount(jobSystem),
+           scene.boxCount,
+           scene.groundCount,
+           scene.boxCount + scene.groundCount,
+           stepCount,
+           fixedFPS,
+           subStepCount,
+           stepsPerSecond,
+           p50,
+           p99,
+           maxMs,
+           (double)contactSum / stepCount,
+           contactMax,
+           (double)moveSum / stepCount,
+           transformP50,
+           stepsPerSecond * fixedStep.fixedTimeStep,
+           p99 <= budgetMs ? "true" : "false");
+    fflush(stdout);
+
+    free(stepMs);
+    free(transformMs);
+    DestroyEntityStore(&entities);
+    DestroyScene(&scene);
+    JobSystemDestroy(jobSystem);
+}
+
+int BenchPhysics(int argc, char **argv)
+{
+    float fixedFPS = (float)BenchArgDouble(argc, argv, "--fixed-fps", 60.0);
+    int subStepCount = BenchArgInt(argc, argv, "--substeps", 4);
+    int warmupCount = BenchArgInt(argc, argv, "--warmup", 60);
+    int stepCount = BenchArgInt(argc, argv, "--steps", 600);
+    int boxCount = BenchArgInt(argc, argv, "--boxes", 0);
+    int groundCount = BenchArgInt(argc, argv, "--ground", 0);
+    const char *tracePath = BenchArg(argc, argv, "--trace");
+    PROFILE_THREAD_NAME("bench");
+
+    int workerCounts[16] = {1};
+    int workerRunCount = BenchArgIntList(argc, argv, "--workers", workerCounts, 16);
+    workerRunCount = workerRunCount > 0 ? workerRunCount : 1;
+
+    SceneDef def = DefaultSceneDef();
+    def.stackHeight = BenchArgInt(argc, argv, "--stack-height", def.stackHeight);
+
+    if (stepCount <= 0 || def.stackHeight <= 0)
+    {
+        fprintf(stderr, "--steps and --stack-height must be positive\n");
+        return 1;
+    }
+
+    int runCount = boxCount > 0 ? 1 : (int)(sizeof(sweepBoxCounts) / sizeof(sweepBoxCounts[0]));
+    for (int run = 0; run < runCount; ++run)
+    {
+        def.boxCount = boxCount > 0 ? boxCount : sweepBoxCounts[run];
+
+        // Unless told otherwise, widen the floor so every stack lands on ground
+        int stackCount = (def.boxCount + def.stackHeight - 1) / def.stackHeight;
+        int coveredCount = stackCount * SCENE_STACK_SPACING + 20;
+        def.groundCount = groundCount > 0 ? groundCount
+                                          : (coveredCount > 20 ? coveredCount : 20);
+
+        for (int i = 0; i < workerRunCount; ++i)
+        {
+            RunPhysics(&def, workerCounts[i], fixedFPS, subStepCount, warmupCount, stepCount);
+        }
+    }
+
+    if (tracePath != NULL)
+    {
+#if defined(ENABLE_PROFILER)
+        // Only the most recent events survive in each thread's ring, so this covers the last run
+        if (!ProfilerExportChromeTrace(tracePath))
+        {
+            fprintf(stderr, "Could not write trace to %s\n", tracePath);
+            return 1;
+        }
+#else
+        fprintf(stderr, "--trace needs a build with RAYLIB_TEMPLATE_PROFILER enabled\n");
+        return 1;
+#endif
+    }
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "bench.h"
+#include "entities.h"
+#include "jobs.h"
+#include "physics_thread.h"
+#include "scene.h"
+#include "timer.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Current poses of the last snapshot the reader saw. The snapshot itself is recycled by the
+// triple buffer, so they are copied out.
+typedef struct SeenPoses
+{
+    float *currentX;
+    float *currentY;
+    float *currentC;
+    float *currentS;
+    int count;
+    uint64_t stepIndex;
+} SeenPoses;
+
+static void RememberPoses(SeenPoses *seen, const PoseSnapshot *snapshot)
+{
+    size_t size = sizeof(float) * (size_t)snapshot->count;
+    seen->currentX = realloc(seen->currentX, size);
+    seen->currentY = realloc(seen->currentY, size);
+    seen->currentC = realloc(seen->currentC, size);
+    seen->currentS = realloc(seen->currentS, size);
+    memcpy(seen->currentX, snapshot->currentX, size);
+    memcpy(seen->currentY, snapshot->currentY, size);
+    memcpy(seen->currentC, snapshot->currentC, size);
+    memcpy(seen->currentS, snapshot->currentS, size);
+    seen->count = snapshot->count;
+    seen->stepIndex = snapshot->stepIndex;
+}
+
+// The step after a seen snapshot must start exactly where it ended. A torn handoff mixes poses
+// of different steps and a stale one repeats old poses, both of which break the match.
+static bool IsContinuous(const SeenPoses *seen, const PoseSnapshot *snapshot)
+{
+    size_t size = sizeof(float) * (size_t)snapshot->count;
+    return snapshot->count == seen->count &&
+           memcmp(snapshot->previousX, seen->currentX, size) == 0 &&
+           memcmp(snapshot->previousY, seen->currentY, size) == 0 &&
+           memcmp(snapshot->previousC, seen->currentC, size) == 0 &&
+           memcmp(snapshot->previousS, seen->currentS, size) == 0;
+}
+
+// Counts interpolated poses with a non unit rotation
+static int CheckRotations(const InterpolatedPoses *poses)
+{
+    int violationCount = 0;
+    for (int i = 0; i < poses->count; ++i)
+    {
+        float c = poses->rotationC[i];
+        float s = poses->rotationS[i];
+        violationCount += fabsf(c * c + s * s - 1.0f) < 1e-3f ? 0 : 1;
+    }
+
+    return violationCount;
+}
+
+// Renders headless against the physics thread: every frame takes the newest snapshot, checks that
+// it continues the previous one and interpolates it. Optional render stalls show that physics keeps
+// its own rate.
+int BenchSnapshot(int argc, char **argv)
+{
+    double seconds = BenchArgDouble(argc, argv, "--seconds", 3.0);
+    double renderFPS = BenchArgDouble(argc, argv, "--render-fps", 144.0);
+    double fixedFPS = BenchArgDouble(argc, argv, "--fixed-fps", 60.0);
+    double stallMs = BenchArgDouble(argc, argv, "--stall-ms", 0.0);
+    int workerCount = BenchArgInt(argc, argv, "--workers", 1);
+
+    SceneDef def = DefaultSceneDef();
+    def.boxCount = BenchArgInt(argc, argv, "--boxes", 1024);
+    int stackCount = (def.boxCount + def.stackHeight - 1) / def.stackHeight;
+    def.groundCount = stackCount * SCENE_STACK_SPACING + 20;
+
+    JobSystem *jobSystem = JobSystemCreate(workerCount);
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    JobSystemConfigureWorld(jobSystem, &worldDef);
+    Scene scene = CreateScene(&worldDef, &def);
+
+    EntityStore entities = CreateEntityStore(scene.groundCount + scene.boxCount);
+    for (int i = 0; i < scene.groundCount; ++i)
+    {
+        CreateEntity(&entities, scene.groundBodies[i], 0);
+    }
+    for (int i = 0; i < scene.boxCount; ++i)
+    {
+        CreateEntity(&entities, scene.boxBodies[i], 1);
+    }
+
+    PhysicsThreadDef physicsDef = {0};
+    physicsDef.worldId = scene.worldId;
+    physicsDef.entities = &entities;
+    physicsDef.jobSystem = jobSystem;
+    physicsDef.fixedTimeStep = 1.0 / fixedFPS;
+    physicsDef.subStepCount = 4;
+    PhysicsThread *physics = StartPhysicsThread(&physicsDef);
+    if (physics == NULL)
+    {
+        fprintf(stderr, "Failed to start the physics thread\n");
+        DestroyEntityStore(&entities);
+        DestroyScene(&scene);
+        JobSystemDestroy(jobSystem);
+        return 1;
+    }
+
+    InterpolatedPoses poses = {0};
+    uint64_t frameNanoseconds = (uint64_t)(1e9 / renderFPS);
+    uint64_t start = TimerNow();
+    uint64_t end = start + (uint64_t)(seconds * 1e9);
+    SeenPoses seen = {0};
+    RememberPoses(&seen, AcquirePhysicsSnapshot(physics));
+    uint64_t firstStepIndex = seen.stepIndex;
+    int frameCount = 0;
+    int snapshotCount = 0;
+    int continuityCount = 0;
+    int violationCount = 0;
+
+    for (uint64_t now = start; now < end; now = TimerNow())
+    {
+        const PoseSnapshot *snapshot = AcquirePhysicsSnapshot(physics);
+        if (snapshot->stepIndex < seen.stepIndex)
+        {
+            ++violationCount;
+        }
+        else if (snapshot->stepIndex > seen.stepIndex)
+        {
+            // Without a view nothing is culled, so consecutive steps carry the same entities.
+            // Steps skipped while the renderer was busy cannot be checked.
+            if (snapshot->stepIndex == seen.stepIndex + 1)
+            {
+                violationCount += IsContinuous(&seen, snapshot) ? 0 : 1;
+                ++continuityCount;
+            }
+
+            ++snapshotCount;
+            RememberPoses(&seen, snapshot);
+        }
+
+        float alpha = GetSnapshotAlpha(snapshot, physicsDef.fixedTimeStep, now);
+        violationCount += (alpha < 0.0f || alpha > 1.0f) ? 1 : 0;
+
+        InterpolateSnapshot(snapshot, alpha, &poses);
+        violationCount += CheckRotations(&poses);
+
+        ++frameCount;
+        if (stallMs > 0.0 && frameCount % 30 == 0)
+        {
+            TimerSleep((uint64_t)(stallMs * 1e6));
+        }
+
+        uint64_t frameEnd = now + frameNanoseconds;
+        uint64_t after = TimerNow();
+        if (after < frameEnd)
+        {
+            TimerSleep(frameEnd - after);
+        }
+    }
+
+    double elapsed = TimerSeconds(start, TimerNow());
+    StopPhysicsThread(physics);
+
+    printf("{\"scenario\":\"snapshot\",\"boxes\":%d,\"workers\":%d,\"seconds\":%.2f,"
+           "\"renderFrames\":%d,\"snapshots\":%d,\"continuityChecks\":%d,\"physicsHz\":%.2f,"
+           "\"fixedFPS\":%.1f,\"stallMs\":%.1f,\"violations\":%d}\n",
+           scene.boxCount,
+           workerCount,
+           elapsed,
+           frameCount,
+           snapshotCount,
+           continuityCount,
+           (double)(seen.stepIndex - firstStepIndex) / elapsed,
+           fixedFPS,
+           stallMs,
+           violationCount);
+    fflush(stdout);
+
+    free(seen.currentX);
+    free(seen.currentY);
+    free(seen.currentC);
+    free(seen.currentS);
+    FreeInterpolatedPoses(&poses);
+    DestroyEntityStore(&entities);
+    DestroyScene(&scene);
+    JobSystemDestroy(jobSystem);
+
+    return violationCount == 0 ? 0 : 1;
+}
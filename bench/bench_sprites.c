@@ -0,0 +1,217 @@
+#include "bench.h"
+#include "spritebatch.h"
+#include "timer.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Quad counts used when no --quads is given
+static const int sweepQuadCounts[] = {1024, 16384, 131072, 1048576};
+
+// Small deterministic generator so every run builds the same scene
+static float RandomFloat(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (float)(*state >> 8) / 16777216.0f;
+}
+
+// Largest difference from the reference, in pixels for corners and texels for UVs, that counts as a
+// match. The batch and the reference round differently, nothing more.
+#define SPRITE_CHECK_TOLERANCE 1.0e-3f
+
+// The corners raylib's DrawTextureEx(texture, position, rotation, scale, WHITE) emits, through
+// DrawTexturePro with the whole texture as source, the position as the destination's top left and
+// no origin. Written out here because the benchmark does not link raylib. The order and UVs are
+// those of the batch, with the texture's full region narrowed to the frame.
+static void ReferenceQuad(SpriteVertex *v,
+                          float x,
+                          float y,
+                          float size,
+                          float rotationDegrees,
+                          const SpriteFrame *frame)
+{
+    float s = sinf(rotationDegrees * (3.14159265f / 180.0f));
+    float c = cosf(rotationDegrees * (3.14159265f / 180.0f));
+    v[0] = (SpriteVertex){x, y, frame->u0, frame->v0};
+    v[1] = (SpriteVertex){x - size * s, y + size * c, frame->u0, frame->v1};
+    v[2] = (SpriteVertex){x + size * c - size * s, y + size * s + size * c, frame->u1, frame->v1};
+    v[3] = (SpriteVertex){x + size * c, y + size * s, frame->u1, frame->v0};
+}
+
+// Builds one rotated sprite away from the origin and the camera, and compares its quad with what
+// the game drew per body before batching: the body's top left corner through ConvertWorldToScreen,
+// rotated by the negated angle for the y flip, scaled to one tile. A second sprite with an unknown
+// id must be skipped. Returns non-zero on a mismatch.
+static int CheckSprites(void)
+{
+    float angle = 0.7f;
+    float positionX[2] = {3.25f, 0.0f};
+    float positionY[2] = {-1.5f, 0.0f};
+    float rotationC[2] = {cosf(angle), 1.0f};
+    float rotationS[2] = {sinf(angle), 0.0f};
+    int spriteIds[2] = {1, 2};
+
+    // Second of two frames on the second page, a sub-rectangle so the UVs are not just 0 and 1
+    SpriteFrame frames[2] = {{0, 0.0f, 0.0f, 1.0f, 1.0f}, {1, 0.25f, 0.5f, 0.75f, 0.625f}};
+    SpriteInstances instances = {positionX, positionY, rotationC, rotationS, spriteIds, 2};
+    Conversion cv = {40.0f, 1.5f, 1280.0f, 720.0f, {2.0f, 0.5f}};
+
+    SpriteBatch batch = CreateSpriteBatch(2);
+    BuildSpriteBatch(&batch, &instances, frames, 2, 2, cv);
+
+    float halfSize = 0.5f * cv.tileSize;
+    b2Vec2 topLeft = {positionX[0] - halfSize * rotationC[0] - halfSize * rotationS[0],
+                      positionY[0] - halfSize * rotationS[0] + halfSize * rotationC[0]};
+    b2Vec2 screen = ConvertWorldToScreen(topLeft, cv);
+    SpriteVertex reference[4];
+    ReferenceQuad(reference,
+                  screen.x,
+                  screen.y,
+                  cv.tileSize * cv.scale,
+                  -angle * (180.0f / 3.14159265f),
+                  frames + spriteIds[0]);
+
+    float cornerError = 0.0f;
+    float uvError = 0.0f;
+    for (int i = 0; i < 4; ++i)
+    {
+        const SpriteVertex *a = batch.vertices + i;
+        const SpriteVertex *b = reference + i;
+        cornerError = fmaxf(cornerError, fmaxf(fabsf(a->x - b->x), fabsf(a->y - b->y)));
+        uvError = fmaxf(uvError, fmaxf(fabsf(a->u - b->u), fabsf(a->v - b->v)));
+    }
+
+    bool grouped = batch.quadCount == 1 && batch.skippedCount == 1 && batch.groupCount == 1 &&
+                   batch.groups[0].page == 1;
+    bool match =
+        grouped && cornerError <= SPRITE_CHECK_TOLERANCE && uvError <= SPRITE_CHECK_TOLERANCE;
+
+    printf("{\"scenario\":\"sprites-check\",\"cornerError\":%g,\"uvError\":%g,\"grouped\":%s,"
+           "\"match\":%s}\n",
+           (double)cornerError,
+           (double)uvError,
+           grouped ? "true" : "false",
+           match ? "true" : "false");
+    fflush(stdout);
+
+    if (!match)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            const SpriteVertex *a = batch.vertices + i;
+            const SpriteVertex *b = reference + i;
+            fprintf(stderr,
+                    "corner %d: batch (%g, %g, %g, %g), reference (%g, %g, %g, %g)\n",
+                    i,
+                    (double)a->x,
+                    (double)a->y,
+                    (double)a->u,
+                    (double)a->v,
+                    (double)b->x,
+                    (double)b->y,
+                    (double)b->u,
+                    (double)b->v);
+        }
+    }
+
+    DestroySpriteBatch(&batch);
+    return match ? 0 : 1;
+}
+
+static void RunSprites(int quadCount, int pageCount, int iterationCount)
+{
+    float *positionX = malloc(sizeof(float) * (size_t)quadCount);
+    float *positionY = malloc(sizeof(float) * (size_t)quadCount);
+    float *rotationC = malloc(sizeof(float) * (size_t)quadCount);
+    float *rotationS = malloc(sizeof(float) * (size_t)quadCount);
+    int *spriteIds = malloc(sizeof(int) * (size_t)quadCount);
+
+    // One full-page frame per page
+    SpriteFrame *frames = malloc(sizeof(SpriteFrame) * (size_t)pageCount);
+    for (int i = 0; i < pageCount; ++i)
+    {
+        frames[i] = (SpriteFrame){i, 0.0f, 0.0f, 1.0f, 1.0f};
+    }
+
+    uint32_t state = 12345u;
+    for (int i = 0; i < quadCount; ++i)
+    {
+        float angle = 2.0f * 3.14159265f * RandomFloat(&state);
+        positionX[i] = 40.0f * RandomFloat(&state) - 20.0f;
+        positionY[i] = 20.0f * RandomFloat(&state) - 10.0f;
+        rotationC[i] = cosf(angle);
+        rotationS[i] = sinf(angle);
+        spriteIds[i] = (int)(RandomFloat(&state) * pageCount) % pageCount;
+    }
+
+    SpriteInstances instances = {positionX, positionY, rotationC, rotationS, spriteIds, quadCount};
+    Conversion cv = {50.0f, 1.0f, 1280.0f, 720.0f, {0.0f, 0.0f}};
+    SpriteBatch batch = CreateSpriteBatch(quadCount);
+
+    double *buildMs = malloc(sizeof(double) * (size_t)iterationCount);
+    double totalSeconds = 0.0;
+    double checksum = 0.0;
+    for (int i = 0; i < iterationCount; ++i)
+    {
+        uint64_t start = TimerNow();
+        BuildSpriteBatch(&batch, &instances, frames, pageCount, pageCount, cv);
+        uint64_t end = TimerNow();
+
+        double seconds = TimerSeconds(start, end);
+        buildMs[i] = 1000.0 * seconds;
+        totalSeconds += seconds;
+
+        // Keeps the compiler from discarding the work
+        checksum += batch.vertices[4 * (i % quadCount)].x;
+    }
+
+    printf("{\"scenario\":\"sprites\",\"quads\":%d,\"pages\":%d,\"groups\":%d,\"iterations\":%d,"
+           "\"quadsPerSecond\":%.0f,\"p50Ms\":%.4f,\"p99Ms\":%.4f,\"checksum\":%.1f}\n",
+           quadCount,
+           pageCount,
+           batch.groupCount,
+           iterationCount,
+           totalSeconds > 0.0 ? (double)quadCount * iterationCount / totalSeconds : 0.0,
+           BenchPercentile(buildMs, iterationCount, 50.0),
+           BenchPercentile(buildMs, iterationCount, 99.0),
+           checksum);
+    fflush(stdout);
+
+    free(buildMs);
+    DestroySpriteBatch(&batch);
+    free(frames);
+    free(spriteIds);
+    free(rotationS);
+    free(rotationC);
+    free(positionY);
+    free(positionX);
+}
+
+int BenchSprites(int argc, char **argv)
+{
+    int quadCount = BenchArgInt(argc, argv, "--quads", 0);
+    int pageCount = BenchArgInt(argc, argv, "--pages", 4);
+    int iterationCount = BenchArgInt(argc, argv, "--iterations", 200);
+
+    if (pageCount <= 0 || iterationCount <= 0)
+    {
+        fprintf(stderr, "--pages and --iterations must be positive\n");
+        return 1;
+    }
+
+    // A fast batch is only worth timing if it still draws what DrawTextureEx did
+    if (CheckSprites() != 0)
+    {
+        return 1;
+    }
+
+    int runCount = quadCount > 0 ? 1 : (int)(sizeof(sweepQuadCounts) / sizeof(sweepQuadCounts[0]));
+    for (int run = 0; run < runCount; ++run)
+    {
+        RunSprites(quadCount > 0 ? quadCount : sweepQuadCounts[run], pageCount, iterationCount);
+    }
+
+    return 0;
+}
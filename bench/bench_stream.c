@@ -0,0 +1,204 @@
+#include "bench.h"
+#include "entities.h"
+#include "jobs.h"
+#include "scene.h"
+#include "timer.h"
+#include "worldstream.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Streaming budgets used when no --budget-us is given. Zero streams without a budget.
+static const int sweepBudgets[] = {250, 1000, 0};
+
+typedef struct StreamOptions
+{
+    int chunkCount;
+    int tilesPerChunk;
+    int boxesPerChunk;
+    int stackHeight;
+    int workerCount;
+    int stepCount;
+    float fixedFPS;
+    int subStepCount;
+    float speed;   // camera speed in tiles per second
+    float viewWidth;
+    float viewHeight;
+} StreamOptions;
+
+// Sweeps a camera along the streamed scene the way the game's physics thread would: stream around
+// the camera, step, then cull to the view with b2World_OverlapAABB
+static void RunStream(const StreamOptions *options, int budgetMicroseconds)
+{
+    JobSystem *jobSystem = JobSystemCreate(options->workerCount);
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    JobSystemConfigureWorld(jobSystem, &worldDef);
+    b2WorldId worldId = b2CreateWorld(&worldDef);
+
+    float tileSize = 1.0f;
+    SceneChunkDef chunkDef = {0};
+    chunkDef.tileSize = tileSize;
+    chunkDef.tilesPerChunk = options->tilesPerChunk;
+    chunkDef.boxesPerChunk = options->boxesPerChunk;
+    chunkDef.stackHeight = options->stackHeight;
+    chunkDef.boxSprite = 1;
+
+    WorldStreamDef streamDef = DefaultWorldStreamDef();
+    streamDef.generator = GenerateSceneChunk;
+    streamDef.generatorContext = &chunkDef;
+    streamDef.maxChunkBodies = options->tilesPerChunk + options->boxesPerChunk;
+    streamDef.chunkSize = (float)options->tilesPerChunk * tileSize;
+    streamDef.chunkCountX = options->chunkCount;
+    streamDef.origin = (b2Vec2){0.0f, -0.5f * streamDef.chunkSize};
+    streamDef.tileSize = tileSize;
+    streamDef.budgetSeconds = budgetMicroseconds > 0 ? 1e-6 * budgetMicroseconds : 1e9;
+    chunkDef.origin = streamDef.origin;
+
+    EntityStore entities = CreateEntityStore(1024);
+    WorldStream *stream = CreateWorldStream(worldId, &entities, &streamDef);
+
+    int *visible = NULL;
+    uint8_t *marks = NULL;
+    int visibleCapacity = 0;
+
+    int stepCount = options->stepCount;
+    double *streamMs = malloc(sizeof(double) * (size_t)stepCount);
+    double *stepMs = malloc(sizeof(double) * (size_t)stepCount);
+    double *cullMs = malloc(sizeof(double) * (size_t)stepCount);
+    long long liveSum = 0;
+    long long visibleSum = 0;
+    long long createdSum = 0;
+    long long destroyedSum = 0;
+    int liveMax = 0;
+    int pendingMax = 0;
+
+    float timeStep = 1.0f / options->fixedFPS;
+    b2Vec2 camera = {0.0f, 0.0f};
+    FlushWorldStream(stream, camera);
+
+    for (int i = 0; i < stepCount; ++i)
+    {
+        camera.x += options->speed * tileSize * timeStep;
+
+        uint64_t start = TimerNow();
+        UpdateWorldStream(stream, camera);
+        uint64_t streamEnd = TimerNow();
+
+        b2World_Step(worldId, timeStep, options->subStepCount);
+        ApplyBodyMoveEvents(&entities, b2World_GetBodyEvents(worldId));
+        uint64_t stepEnd = TimerNow();
+
+        if (entities.count > visibleCapacity)
+        {
+            free(visible);
+            free(marks);
+            visibleCapacity = entities.capacity;
+            visible = malloc(sizeof(int) * (size_t)visibleCapacity);
+            marks = calloc((size_t)visibleCapacity, sizeof(uint8_t));
+        }
+
+        float halfWidth = 0.5f * options->viewWidth;
+        float halfHeight = 0.5f * options->viewHeight;
+        b2AABB view = {{camera.x - halfWidth, camera.y - halfHeight},
+                       {camera.x + halfWidth, camera.y + halfHeight}};
+        int visibleCount = QueryEntitiesInAABB(&entities, worldId, view, visible, marks);
+        uint64_t cullEnd = TimerNow();
+
+        WorldStreamStats stats = GetWorldStreamStats(stream);
+        streamMs[i] = 1000.0 * TimerSeconds(start, streamEnd);
+        stepMs[i] = 1000.0 * TimerSeconds(streamEnd, stepEnd);
+        cullMs[i] = 1000.0 * TimerSeconds(stepEnd, cullEnd);
+        liveSum += stats.liveBodyCount;
+        visibleSum += visibleCount;
+        createdSum += stats.createdBodyCount;
+        destroyedSum += stats.destroyedBodyCount;
+        liveMax = stats.liveBodyCount > liveMax ? stats.liveBodyCount : liveMax;
+        pendingMax = stats.pendingChunkCount > pendingMax ? stats.pendingChunkCount : pendingMax;
+    }
+
+    double streamP50 = BenchPercentile(streamMs, stepCount, 50.0);
+    double streamP99 = BenchPercentile(streamMs, stepCount, 99.0);
+    double streamMax = streamMs[stepCount - 1];
+    double stepP50 = BenchPercentile(stepMs, stepCount, 50.0);
+    double stepP99 = BenchPercentile(stepMs, stepCount, 99.0);
+    double cullP50 = BenchPercentile(cullMs, stepCount, 50.0);
+    int levelBodies = options->chunkCount * (options->tilesPerChunk + options->boxesPerChunk);
+
+    printf("{\"scenario\":\"stream\",\"budgetUs\":%d,\"workers\":%d,\"chunks\":%d,"
+           "\"levelBodies\":%d,\"steps\":%d,\"speed\":%.1f,\"streamP50Ms\":%.4f,"
+           "\"streamP99Ms\":%.4f,\"streamMaxMs\":%.4f,\"stepP50Ms\":%.4f,\"stepP99Ms\":%.4f,"
+           "\"cullP50Ms\":%.4f,\"meanLiveBodies\":%.1f,\"maxLiveBodies\":%d,\"meanVisible\":%.1f,"
+           "\"created\":%lld,\"destroyed\":%lld,\"maxPendingChunks\":%d}\n",
+           budgetMicroseconds,
+           JobSystemGetWorkerCount(jobSystem),
+           options->chunkCount,
+           levelBodies,
+           stepCount,
+           options->speed,
+           streamP50,
+           streamP99,
+           streamMax,
+           stepP50,
+           stepP99,
+           cullP50,
+           (double)liveSum / stepCount,
+           liveMax,
+           (double)visibleSum / stepCount,
+           createdSum,
+           destroyedSum,
+           pendingMax);
+    fflush(stdout);
+
+    free(streamMs);
+    free(stepMs);
+    free(cullMs);
+    free(visible);
+    free(marks);
+    DestroyWorldStream(stream);
+    DestroyEntityStore(&entities);
+    b2DestroyWorld(worldId);
+    JobSystemDestroy(jobSystem);
+}
+
+int BenchStream(int argc, char **argv)
+{
+    StreamOptions options = {0};
+    options.chunkCount = BenchArgInt(argc, argv, "--chunks", 256);
+    options.tilesPerChunk = BenchArgInt(argc, argv, "--tiles-per-chunk", 16);
+    options.boxesPerChunk = BenchArgInt(argc, argv, "--boxes-per-chunk", 8);
+    options.stackHeight = BenchArgInt(argc, argv, "--stack-height", 4);
+    options.workerCount = BenchArgInt(argc, argv, "--workers", 1);
+    options.stepCount = BenchArgInt(argc, argv, "--steps", 1200);
+    options.fixedFPS = (float)BenchArgDouble(argc, argv, "--fixed-fps", 60.0);
+    options.subStepCount = BenchArgInt(argc, argv, "--substeps", 4);
+    options.speed = (float)BenchArgDouble(argc, argv, "--speed", 40.0);
+
+    // The game's 1280x720 window at 50 pixels per tile
+    options.viewWidth = 25.6f;
+    options.viewHeight = 14.4f;
+
+    if (options.chunkCount <= 0 || options.tilesPerChunk <= 0 || options.stepCount <= 0)
+    {
+        fprintf(stderr, "--chunks, --tiles-per-chunk and --steps must be positive\n");
+        return 1;
+    }
+
+    int budgets[16] = {0};
+    int budgetCount = BenchArgIntList(argc, argv, "--budget-us", budgets, 16);
+    if (budgetCount == 0)
+    {
+        budgetCount = (int)(sizeof(sweepBudgets) / sizeof(sweepBudgets[0]));
+        for (int i = 0; i < budgetCount; ++i)
+        {
+            budgets[i] = sweepBudgets[i];
+        }
+    }
+
+    for (int i = 0; i < budgetCount; ++i)
+    {
+        RunStream(&options, budgets[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include "bench.h"
+#include "jobs.h"
+#include "tilemap.h"
+#include "timer.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Floor widths in tiles used when no --width is given
+static const int sweepWidths[] = {1024, 16384, 131072};
+
+typedef struct TilesOptions
+{
+    int width;
+    int rows;
+    int gapEvery;
+    int boxCount;
+    float slideSpeed;
+    int workerCount;
+    int warmupCount;
+    int stepCount;
+    float fixedFPS;
+    int subStepCount;
+} TilesOptions;
+
+// A floor of the given rows, broken by a one tile gap every gapEvery tiles
+static TileLayer MakeFloorLayer(const TilesOptions *options)
+{
+    TileLayer layer = CreateTileLayer(options->width, options->rows, (b2Vec2){0.0f, 0.0f}, 1.0f);
+    for (int y = 0; y < layer.height; ++y)
+    {
+        for (int x = 0; x < layer.width; ++x)
+        {
+            bool gap = options->gapEvery > 0 && x % options->gapEvery == options->gapEvery - 1;
+            layer.tiles[y * layer.width + x] = gap ? TILE_EMPTY : 0;
+        }
+    }
+
+    return layer;
+}
+
+// The body and box shape per tile that the scene and world stream create
+static void CreateTileBodies(b2WorldId worldId, const TileLayer *layer)
+{
+    b2Polygon tilePolygon = b2MakeSquare(0.5f * layer->tileSize);
+    for (int y = 0; y < layer->height; ++y)
+    {
+        for (int x = 0; x < layer->width; ++x)
+        {
+            if (!IsTileSolid(layer, x, y))
+            {
+                continue;
+            }
+
+            b2BodyDef bodyDef = b2DefaultBodyDef();
+            bodyDef.position = (b2Vec2){layer->origin.x + ((float)x + 0.5f) * layer->tileSize,
+                                        layer->origin.y + ((float)y + 0.5f) * layer->tileSize};
+            b2BodyId bodyId = b2CreateBody(worldId, &bodyDef);
+            b2ShapeDef shapeDef = b2DefaultShapeDef();
+            b2CreatePolygonShape(bodyId, &shapeDef, &tilePolygon);
+        }
+    }
+}
+
+// Boxes spread evenly over the floor, sliding along it so they cross tile seams
+static void CreateSlidingBoxes(b2WorldId worldId,
+                               const TileLayer *layer,
+                               const TilesOptions *options)
+{
+    float tileSize = layer->tileSize;
+    b2Polygon boxPolygon = b2MakeSquare(0.5f * tileSize);
+    float spacing = (float)layer->width * tileSize / (float)options->boxCount;
+    for (int i = 0; i < options->boxCount; ++i)
+    {
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.position = (b2Vec2){layer->origin.x + ((float)i + 0.5f) * spacing,
+                                    layer->origin.y + ((float)layer->height + 0.5f) * tileSize};
+        b2BodyId bodyId = b2CreateBody(worldId, &bodyDef);
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        shapeDef.restitution = 0.1f;
+        b2CreatePolygonShape(bodyId, &shapeDef, &boxPolygon);
+        b2Body_SetLinearVelocity(bodyId, (b2Vec2){options->slideSpeed, 0.0f});
+    }
+}
+
+static void RunTiles(const TilesOptions *options, bool merged)
+{
+    JobSystem *jobSystem = JobSystemCreate(options->workerCount);
+    b2WorldDef worldDef = b2DefaultWorldDef();
+    JobSystemConfigureWorld(jobSystem, &worldDef);
+    b2WorldId worldId = b2CreateWorld(&worldDef);
+
+    TileLayer layer = MakeFloorLayer(options);
+
+    uint64_t buildStart = TimerNow();
+    TileOutlines outlines = {0};
+    TileColliders colliders = {0};
+    double compileMs = 0.0;
+    if (merged)
+    {
+        outlines = CompileTileOutlines(&layer);
+        compileMs = 1000.0 * TimerSeconds(buildStart, TimerNow());
+        b2ChainDef chainDef = b2DefaultChainDef();
+        colliders = CreateTileColliders(worldId, &layer, &outlines, &chainDef);
+    }
+    else
+    {
+        CreateTileBodies(worldId, &layer);
+    }
+    double buildMs = 1000.0 * TimerSeconds(buildStart, TimerNow());
+
+    CreateSlidingBoxes(worldId, &layer, options);
+    b2Counters counters = b2World_GetCounters(worldId);
+    int bodyCount = counters.bodyCount;
+    int proxyCount = counters.shapeCount;
+
+    int stepCount = options->stepCount;
+    double *stepMs = malloc(sizeof(double) * (size_t)stepCount);
+    double totalMs = 0.0;
+    long long contactSum = 0;
+    int contactMax = 0;
+
+    float timeStep = 1.0f / options->fixedFPS;
+    for (int i = 0; i < options->warmupCount + stepCount; ++i)
+    {
+        uint64_t start = TimerNow();
+        b2World_Step(worldId, timeStep, options->subStepCount);
+        uint64_t end = TimerNow();
+
+        if (i >= options->warmupCount)
+        {
+            int index = i - options->warmupCount;
+            stepMs[index] = 1000.0 * TimerSeconds(start, end);
+            totalMs += stepMs[index];
+
+            counters = b2World_GetCounters(worldId);
+            contactSum += counters.contactCount;
+            contactMax = counters.contactCount > contactMax ? counters.contactCount : contactMax;
+        }
+    }
+
+    double p50 = BenchPercentile(stepMs, stepCount, 50.0);
+    double p99 = BenchPercentile(stepMs, stepCount, 99.0);
+
+    printf("{\"scenario\":\"tiles\",\"colliders\":\"%s\",\"workers\":%d,\"width\":%d,\"rows\":%d,"
+           "\"boxes\":%d,\"bodies\":%d,\"proxies\":%d,\"regions\":%d,\"chains\":%d,"
+           "\"compileMs\":%.3f,\"buildMs\":%.3f,\"steps\":%d,\"meanMs\":%.4f,\"p50Ms\":%.4f,"
+           "\"p99Ms\":%.4f,\"meanContacts\":%.1f,\"maxContacts\":%d}\n",
+           merged ? "chains" : "tiles",
+           JobSystemGetWorkerCount(jobSystem),
+           options->width,
+           options->rows,
+           options->boxCount,
+           bodyCount,
+           proxyCount,
+           outlines.regionCount,
+           colliders.chainCount,
+           compileMs,
+           buildMs,
+           stepCount,
+           totalMs / stepCount,
+           p50,
+           p99,
+           (double)contactSum / stepCount,
+           contactMax);
+    fflush(stdout);
+
+    free(stepMs);
+    DestroyTileColliders(&colliders);
+    FreeTileOutlines(&outlines);
+    DestroyTileLayer(&layer);
+    b2DestroyWorld(worldId);
+    JobSystemDestroy(jobSystem);
+}
+
+int BenchTiles(int argc, char **argv)
+{
+    TilesOptions options = {0};
+    options.rows = BenchArgInt(argc, argv, "--rows", 2);
+    options.gapEvery = BenchArgInt(argc, argv, "--gap-every", 256);
+    options.boxCount = BenchArgInt(argc, argv, "--boxes", 0);
+    options.slideSpeed = (float)BenchArgDouble(argc, argv, "--slide", 4.0);
+    options.workerCount = BenchArgInt(argc, argv, "--workers", 1);
+    options.warmupCount = BenchArgInt(argc, argv, "--warmup", 60);
+    options.stepCount = BenchArgInt(argc, argv, "--steps", 600);
+    options.fixedFPS = (float)BenchArgDouble(argc, argv, "--fixed-fps", 60.0);
+    options.subStepCount = BenchArgInt(argc, argv, "--substeps", 4);
+
+    if (options.rows <= 0 || options.stepCount <= 0)
+    {
+        fprintf(stderr, "--rows and --steps must be positive\n");
+        return 1;
+    }
+
+    int widths[16] = {0};
+    int widthCount = BenchArgIntList(argc, argv, "--width", widths, 16);
+    if (widthCount == 0)
+    {
+        widthCount = (int)(sizeof(sweepWidths) / sizeof(sweepWidths[0]));
+        for (int i = 0; i < widthCount; ++i)
+        {
+            widths[i] = sweepWidths[i];
+        }
+    }
+
+    int boxCount = options.boxCount;
+    for (int i = 0; i < widthCount; ++i)
+    {
+        // Unless told otherwise, one box per 16 tiles
+        options.width = widths[i];
+        options.boxCount = boxCount > 0 ? boxCount : (widths[i] / 16 > 1 ? widths[i] / 16 : 1);
+        RunTiles(&options, false);
+        RunTiles(&options, true);
+    }
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+#if !defined(_WIN32) && !defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "assetpack.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool MapFile(const char *path, AssetPack *pack)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path,
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                              NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    pack->data = data;
+    pack->size = (size_t)size.QuadPart;
+    pack->fileHandle = file;
+    pack->mappingHandle = mapping;
+    return true;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        close(file);
+        return false;
+    }
+
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps its own reference to the file
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    pack->data = data;
+    pack->size = (size_t)info.st_size;
+    return true;
+#endif
+}
+
+static void UnmapFile(AssetPack *pack)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(pack->data);
+    CloseHandle(pack->mappingHandle);
+    CloseHandle(pack->fileHandle);
+#else
+    munmap((void *)pack->data, pack->size);
+#endif
+}
+
+static bool ValidatePack(AssetPack *pack)
+{
+    if (pack->size < sizeof(AssetPackHeader))
+    {
+        return false;
+    }
+
+    const AssetPackHeader *header = (const AssetPackHeader *)pack->data;
+    if (header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION ||
+        header->fileSize != pack->size)
+    {
+        return false;
+    }
+
+    uint64_t tableSize = sizeof(AssetPackHeader) +
+                         (uint64_t)header->pageCount * sizeof(AssetPageInfo) +
+                         (uint64_t)header->spriteCount * sizeof(AssetSpriteInfo);
+    if (tableSize > pack->size)
+    {
+        return false;
+    }
+
+    pack->pages = (const AssetPageInfo *)(pack->data + sizeof(AssetPackHeader));
+    pack->pageCount = (int)header->pageCount;
+    pack->sprites = (const AssetSpriteInfo *)(pack->pages + header->pageCount);
+    pack->spriteCount = (int)header->spriteCount;
+
+    for (int i = 0; i < pack->pageCount; ++i)
+    {
+        const AssetPageInfo *page = pack->pages + i;
+        uint64_t expectedSize = (uint64_t)page->width * page->height * 4;
+        if (page->format != ASSET_PIXEL_RGBA8 || page->dataSize != expectedSize ||
+            page->dataOffset % ASSET_PACK_ALIGNMENT != 0 || page->dataOffset > pack->size ||
+            page->dataSize > pack->size - page->dataOffset)
+        {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < pack->spriteCount; ++i)
+    {
+        const AssetSpriteInfo *sprite = pack->sprites + i;
+        if (sprite->page >= header->pageCount ||
+            memchr(sprite->name, '\0', ASSET_NAME_LENGTH) == NULL)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool OpenAssetPack(const char *path, AssetPack *pack)
+{
+    *pack = (AssetPack){0};
+    if (!MapFile(path, pack))
+    {
+        return false;
+    }
+
+    if (!ValidatePack(pack))
+    {
+        CloseAssetPack(pack);
+        return false;
+    }
+
+    return true;
+}
+
+void CloseAssetPack(AssetPack *pack)
+{
+    if (pack->data != NULL)
+    {
+        UnmapFile(pack);
+    }
+
+    *pack = (AssetPack){0};
+}
+
+int FindAssetSprite(const AssetPack *pack, const char *name)
+{
+    for (int i = 0; i < pack->spriteCount; ++i)
+    {
+        if (strncmp(pack->sprites[i].name, name, ASSET_NAME_LENGTH) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+const void *GetAssetPagePixels(const AssetPack *pack, int page)
+{
+    return pack->data + pack->pages[page].dataOffset;
+}
@@ -0,0 +1,85 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Archive of pre-decoded texture pages and the sprites packed into them, written by the
+// asset_cooker tool at build time. The file is memory-mapped, so page pixels can be handed to the
+// GPU straight from the mapping without decoding or copying.
+//
+// Layout: AssetPackHeader, AssetPageInfo[pageCount], AssetSpriteInfo[spriteCount], then the pixel
+// data of each page starting on an ASSET_PACK_ALIGNMENT boundary. All fields are little-endian.
+
+#define ASSET_PACK_MAGIC 0x4B505452u // "RTPK"
+#define ASSET_PACK_VERSION 1u
+#define ASSET_PACK_ALIGNMENT 4096u
+#define ASSET_NAME_LENGTH 32
+
+typedef enum AssetPixelFormat
+{
+    ASSET_PIXEL_RGBA8 = 1,
+} AssetPixelFormat;
+
+typedef struct AssetPackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pageCount;
+    uint32_t spriteCount;
+    uint64_t fileSize;
+} AssetPackHeader;
+
+typedef struct AssetPageInfo
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t reserved;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+} AssetPageInfo;
+
+typedef struct AssetSpriteInfo
+{
+    // Source file name without directory or extension, zero terminated
+    char name[ASSET_NAME_LENGTH];
+    uint32_t page;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+} AssetSpriteInfo;
+
+typedef struct AssetPack
+{
+    const uint8_t *data;
+    size_t size;
+    const AssetPageInfo *pages;
+    int pageCount;
+    const AssetSpriteInfo *sprites;
+    int spriteCount;
+#if defined(_WIN32)
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+} AssetPack;
+
+// Maps the archive read-only and validates its tables. Returns false, leaving pack zeroed, when
+// the file is missing or malformed.
+bool OpenAssetPack(const char *path, AssetPack *pack);
+void CloseAssetPack(AssetPack *pack);
+
+// Returns the sprite index, or -1 when no sprite has that name
+int FindAssetSprite(const AssetPack *pack, const char *name);
+
+// Tightly packed rows of pages[page].width pixels in pages[page].format, valid until the pack is
+// closed
+const void *GetAssetPagePixels(const AssetPack *pack, int page);
+
+#endif // ASSETPACK_H
@@ -0,0 +1,143 @@
+#include "assets.h"
+#include "assetpack.h"
+
+#include <stdlib.h>
+
+static void UnloadPages(GameAssets *assets)
+{
+    for (int i = 0; i < assets->pageCount; ++i)
+    {
+        UnloadTexture(assets->textures[i]);
+    }
+
+    assets->pageCount = 0;
+}
+
+static bool LoadLooseAssets(GameAssets *assets,
+                            const char *directory,
+                            const char *const *spriteNames,
+                            int spriteCount)
+{
+    // Every loose image is a page of its own
+    if (spriteCount > GAME_ASSETS_MAX_PAGES)
+    {
+        TraceLog(LOG_ERROR,
+                 "ASSETS: %d loose sprites in %s, at most %d are supported",
+                 spriteCount,
+                 directory,
+                 GAME_ASSETS_MAX_PAGES);
+        return false;
+    }
+
+    for (int i = 0; i < spriteCount; ++i)
+    {
+        assets->textures[i] = LoadTexture(TextFormat("%s%s.png", directory, spriteNames[i]));
+        if (assets->textures[i].id == 0)
+        {
+            TraceLog(LOG_ERROR,
+                     "ASSETS: Failed to load sprite %s from %s",
+                     spriteNames[i],
+                     directory);
+            UnloadPages(assets);
+            return false;
+        }
+
+        assets->pageTextureIds[i] = assets->textures[i].id;
+        assets->frames[i] = (SpriteFrame){i, 0.0f, 0.0f, 1.0f, 1.0f};
+        assets->pageCount += 1;
+    }
+
+    return assets->pageCount > 0;
+}
+
+static bool LoadPackedAssets(GameAssets *assets,
+                             const char *path,
+                             const char *const *spriteNames,
+                             int spriteCount)
+{
+    AssetPack pack;
+    if (!OpenAssetPack(path, &pack))
+    {
+        TraceLog(LOG_ERROR, "ASSETS: Failed to open asset pack %s", path);
+        return false;
+    }
+
+    if (pack.pageCount <= 0 || pack.pageCount > GAME_ASSETS_MAX_PAGES)
+    {
+        TraceLog(LOG_ERROR,
+                 "ASSETS: %s has %d pages, expected 1 to %d",
+                 path,
+                 pack.pageCount,
+                 GAME_ASSETS_MAX_PAGES);
+        CloseAssetPack(&pack);
+        return false;
+    }
+
+    // A sprite the pack lacks would draw as nothing, so it fails the pack like corruption does.
+    // Checked before uploading anything.
+    for (int i = 0; i < spriteCount; ++i)
+    {
+        int index = FindAssetSprite(&pack, spriteNames[i]);
+        if (index < 0)
+        {
+            TraceLog(LOG_ERROR, "ASSETS: Sprite %s is not in %s", spriteNames[i], path);
+            CloseAssetPack(&pack);
+            return false;
+        }
+
+        const AssetSpriteInfo *sprite = pack.sprites + index;
+        assets->frames[i] = (SpriteFrame){
+            (int)sprite->page, sprite->u0, sprite->v0, sprite->u1, sprite->v1};
+    }
+
+    for (int i = 0; i < pack.pageCount; ++i)
+    {
+        // Uploads straight from the mapping. The image is not ours to unload.
+        Image image = {0};
+        image.data = (void *)GetAssetPagePixels(&pack, i);
+        image.width = (int)pack.pages[i].width;
+        image.height = (int)pack.pages[i].height;
+        image.mipmaps = 1;
+        image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        assets->textures[i] = LoadTextureFromImage(image);
+        assets->pageTextureIds[i] = assets->textures[i].id;
+    }
+
+    assets->pageCount = pack.pageCount;
+
+    // Textures live on the GPU now
+    CloseAssetPack(&pack);
+    return true;
+}
+
+GameAssets LoadGameAssets(const char *path,
+                          const char *fallbackDirectory,
+                          const char *const *spriteNames,
+                          int spriteCount)
+{
+    GameAssets assets = {0};
+    assets.frames = calloc((size_t)spriteCount, sizeof(SpriteFrame));
+    assets.frameCount = spriteCount;
+
+    if (DirectoryExists(path))
+    {
+        LoadLooseAssets(&assets, path, spriteNames, spriteCount);
+        return assets;
+    }
+
+    assets.packed = LoadPackedAssets(&assets, path, spriteNames, spriteCount);
+    if (!assets.packed && fallbackDirectory != NULL && DirectoryExists(fallbackDirectory))
+    {
+        TraceLog(LOG_WARNING, "ASSETS: Falling back to loose images in %s", fallbackDirectory);
+        LoadLooseAssets(&assets, fallbackDirectory, spriteNames, spriteCount);
+    }
+
+    return assets;
+}
+
+void UnloadGameAssets(GameAssets *assets)
+{
+    UnloadPages(assets);
+    free(assets->frames);
+    *assets = (GameAssets){0};
+}
@@ -0,0 +1,34 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "raylib.h"
+#include "spritebatch.h"
+
+#include <stdbool.h>
+
+// Also the most sprites that can be loaded from loose images, one page each
+#define GAME_ASSETS_MAX_PAGES 16
+
+// Textures and sprite frames of the game. Loaded from the cooked archive, or from one image file
+// per sprite when the path is a directory.
+typedef struct GameAssets
+{
+    Texture2D textures[GAME_ASSETS_MAX_PAGES];
+    unsigned int pageTextureIds[GAME_ASSETS_MAX_PAGES];
+    int pageCount;
+    SpriteFrame *frames;
+    int frameCount;
+    bool packed;
+} GameAssets;
+
+// Frames are returned in the order of spriteNames, so sprite ids index them directly. Loose files
+// are looked up as <path><name>.png. When the pack at path is missing or corrupt the loose images
+// in fallbackDirectory are loaded instead. Shipped builds pass NULL, as they carry the pack only.
+// pageCount is 0 when nothing could be loaded, and the assets must not be drawn.
+GameAssets LoadGameAssets(const char *path,
+                          const char *fallbackDirectory,
+                          const char *const *spriteNames,
+                          int spriteCount);
+void UnloadGameAssets(GameAssets *assets);
+
+#endif // ASSETS_H
@@ -0,0 +1,17 @@
+#include "conversion.h"
+
+b2Vec2 ConvertWorldToScreen(b2Vec2 p, Conversion cv)
+{
+    b2Vec2 result = {cv.scale * (p.x - cv.camera.x) + 0.5f * cv.screenWidth,
+                     0.5f * cv.screenHeight - cv.scale * (p.y - cv.camera.y)};
+    return result;
+}
+
+b2AABB GetConversionView(Conversion cv)
+{
+    float halfWidth = 0.5f * cv.screenWidth / cv.scale;
+    float halfHeight = 0.5f * cv.screenHeight / cv.scale;
+    b2AABB view = {{cv.camera.x - halfWidth, cv.camera.y - halfHeight},
+                   {cv.camera.x + halfWidth, cv.camera.y + halfHeight}};
+    return view;
+}
@@ -0,0 +1,21 @@
+#ifndef CONVERSION_H
+#define CONVERSION_H
+
+#include "box2d/box2d.h"
+
+// Maps Box2D world units (meters, y up) to screen pixels (y down)
+typedef struct Conversion
+{
+    float scale;
+    float tileSize;
+    float screenWidth;
+    float screenHeight;
+    b2Vec2 camera; // world point shown at the center of the screen
+} Conversion;
+
+b2Vec2 ConvertWorldToScreen(b2Vec2 p, Conversion cv);
+
+// World space rectangle covered by the screen
+b2AABB GetConversionView(Conversion cv);
+
+#endif // CONVERSION_H
@@ -0,0 +1,329 @@
+#include "entities.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define NULL_SLOT UINT32_MAX
+
+// Body user data holds slot + 1 so bodies without an entity read as 0
+static void *SlotToUserData(uint32_t slot)
+{
+    return (void *)((uintptr_t)slot + 1);
+}
+
+static uint32_t UserDataToSlot(void *userData)
+{
+    return (uint32_t)((uintptr_t)userData - 1);
+}
+
+// Leaves the array untouched when the allocation fails
+static bool GrowArray(void **array, int capacity, size_t elementSize)
+{
+    void *grown = realloc(*array, (size_t)capacity * elementSize);
+    if (grown == NULL)
+    {
+        return false;
+    }
+
+    *array = grown;
+    return true;
+}
+
+// Capacity only grows once every array has, so a failure part way keeps the store usable
+static bool ReserveDense(EntityStore *store, int capacity)
+{
+    if (capacity <= store->capacity)
+    {
+        return true;
+    }
+
+    bool grown = true;
+    grown = grown && GrowArray((void **)&store->bodyIds, capacity, sizeof(b2BodyId));
+    grown = grown && GrowArray((void **)&store->spriteIds, capacity, sizeof(int));
+    grown = grown && GrowArray((void **)&store->positionX, capacity, sizeof(float));
+    grown = grown && GrowArray((void **)&store->positionY, capacity, sizeof(float));
+    grown = grown && GrowArray((void **)&store->rotationC, capacity, sizeof(float));
+    grown = grown && GrowArray((void **)&store->rotationS, capacity, sizeof(float));
+    grown = grown && GrowArray((void **)&store->previousX, capacity, sizeof(float));
+    grown = grown && GrowArray((void **)&store->previousY, capacity, sizeof(float));
+    grown = grown && GrowArray((void **)&store->previousC, capacity, sizeof(float));
+    grown = grown && GrowArray((void **)&store->previousS, capacity, sizeof(float));
+    grown = grown && GrowArray((void **)&store->moveSteps, capacity, sizeof(uint32_t));
+    grown = grown && GrowArray((void **)&store->slots, capacity, sizeof(uint32_t));
+    if (!grown)
+    {
+        return false;
+    }
+
+    store->capacity = capacity;
+    return true;
+}
+
+static bool ReserveSlots(EntityStore *store, int capacity)
+{
+    if (capacity <= store->slotCapacity)
+    {
+        return true;
+    }
+
+    if (!GrowArray((void **)&store->denseIndices, capacity, sizeof(uint32_t)) ||
+        !GrowArray((void **)&store->generations, capacity, sizeof(uint32_t)))
+    {
+        return false;
+    }
+
+    store->slotCapacity = capacity;
+    return true;
+}
+
+static void UpdateTransform(EntityStore *store, int index, b2Vec2 position, float c, float s)
+{
+    store->positionX[index] = position.x;
+    store->positionY[index] = position.y;
+    store->rotationC[index] = c;
+    store->rotationS[index] = s;
+}
+
+// Dense index of the entity a body's user data refers to, or -1 when the slot is out of range or
+// no longer holds a live entity
+static int UserDataToIndex(const EntityStore *store, void *userData)
+{
+    uint32_t slot = UserDataToSlot(userData);
+    if (slot >= (uint32_t)store->slotCount)
+    {
+        return -1;
+    }
+
+    uint32_t index = store->denseIndices[slot];
+    if (index >= (uint32_t)store->count || store->slots[index] != slot)
+    {
+        return -1;
+    }
+
+    return (int)index;
+}
+
+static void ReadBodyTransform(EntityStore *store, int index)
+{
+    b2BodyId bodyId = store->bodyIds[index];
+    float angle = b2Body_GetAngle(bodyId);
+    UpdateTransform(store, index, b2Body_GetPosition(bodyId), cosf(angle), sinf(angle));
+}
+
+EntityStore CreateEntityStore(int capacity)
+{
+    EntityStore store = {0};
+    store.freeSlot = NULL_SLOT;
+    ReserveDense(&store, capacity > 0 ? capacity : 16);
+    ReserveSlots(&store, capacity > 0 ? capacity : 16);
+    return store;
+}
+
+void DestroyEntityStore(EntityStore *store)
+{
+    free(store->bodyIds);
+    free(store->spriteIds);
+    free(store->positionX);
+    free(store->positionY);
+    free(store->rotationC);
+    free(store->rotationS);
+    free(store->previousX);
+    free(store->previousY);
+    free(store->previousC);
+    free(store->previousS);
+    free(store->moveSteps);
+    free(store->slots);
+    free(store->denseIndices);
+    free(store->generations);
+    *store = (EntityStore){0};
+}
+
+static int GrownCapacity(int capacity)
+{
+    return capacity > 0 ? 2 * capacity : 16;
+}
+
+EntityHandle CreateEntity(EntityStore *store, b2BodyId bodyId, int spriteId)
+{
+    // Reserve everything before touching the store so a failed allocation leaves it unchanged
+    bool needsSlot = store->freeSlot == NULL_SLOT && store->slotCount == store->slotCapacity;
+    if ((needsSlot && !ReserveSlots(store, GrownCapacity(store->slotCapacity))) ||
+        (store->count == store->capacity && !ReserveDense(store, GrownCapacity(store->capacity))))
+    {
+        EntityHandle invalid = {NULL_SLOT, 0};
+        return invalid;
+    }
+
+    uint32_t slot = store->freeSlot;
+    if (slot != NULL_SLOT)
+    {
+        store->freeSlot = store->denseIndices[slot];
+    }
+    else
+    {
+        slot = (uint32_t)store->slotCount++;
+        store->generations[slot] = 0;
+    }
+
+    int index = store->count++;
+    store->bodyIds[index] = bodyId;
+    store->spriteIds[index] = spriteId;
+    store->slots[index] = slot;
+    store->denseIndices[slot] = (uint32_t)index;
+
+    b2Body_SetUserData(bodyId, SlotToUserData(slot));
+    ReadBodyTransform(store, index);
+    store->moveSteps[index] = store->moveStep - 1;
+
+    EntityHandle handle = {slot, store->generations[slot]};
+    return handle;
+}
+
+void DestroyEntity(EntityStore *store, EntityHandle handle)
+{
+    int index = GetEntityIndex(store, handle);
+    if (index < 0)
+    {
+        return;
+    }
+
+    // The body may outlive the entity; its events and queries must no longer resolve to the slot
+    b2Body_SetUserData(store->bodyIds[index], NULL);
+
+    // Move the last entity into the hole
+    int last = --store->count;
+    if (index != last)
+    {
+        store->bodyIds[index] = store->bodyIds[last];
+        store->spriteIds[index] = store->spriteIds[last];
+        store->positionX[index] = store->positionX[last];
+        store->positionY[index] = store->positionY[last];
+        store->rotationC[index] = store->rotationC[last];
+        store->rotationS[index] = store->rotationS[last];
+        store->previousX[index] = store->previousX[last];
+        store->previousY[index] = store->previousY[last];
+        store->previousC[index] = store->previousC[last];
+        store->previousS[index] = store->previousS[last];
+        store->moveSteps[index] = store->moveSteps[last];
+        store->slots[index] = store->slots[last];
+        store->denseIndices[store->slots[index]] = (uint32_t)index;
+    }
+
+    store->generations[handle.slot] += 1;
+    store->denseIndices[handle.slot] = store->freeSlot;
+    store->freeSlot = handle.slot;
+}
+
+bool IsEntityValid(const EntityStore *store, EntityHandle handle)
+{
+    return GetEntityIndex(store, handle) >= 0;
+}
+
+int GetEntityIndex(const EntityStore *store, EntityHandle handle)
+{
+    if (handle.slot >= (uint32_t)store->slotCount ||
+        store->generations[handle.slot] != handle.generation)
+    {
+        return -1;
+    }
+
+    return (int)store->denseIndices[handle.slot];
+}
+
+void ApplyBodyMoveEvents(EntityStore *store, b2BodyEvents events)
+{
+    store->moveStep += 1;
+    for (int i = 0; i < events.moveCount; ++i)
+    {
+        const b2BodyMoveEvent *event = events.moveEvents + i;
+        if (event->userData == NULL)
+        {
+            continue;
+        }
+
+        // Bodies whose user data is not a live entity of this store are not ours to track
+        int index = UserDataToIndex(store, event->userData);
+        if (index < 0)
+        {
+            continue;
+        }
+
+        store->previousX[index] = store->positionX[index];
+        store->previousY[index] = store->positionY[index];
+        store->previousC[index] = store->rotationC[index];
+        store->previousS[index] = store->rotationS[index];
+        store->moveSteps[index] = store->moveStep;
+
+        b2Transform transform = event->transform;
+        UpdateTransform(store, index, transform.p, transform.q.c, transform.q.s);
+    }
+}
+
+void ClearEntityMoves(EntityStore *store)
+{
+    store->moveStep += 1;
+}
+
+typedef struct EntityQuery
+{
+    const EntityStore *store;
+    int *indices;
+    uint8_t *marks;
+    int count;
+} EntityQuery;
+
+static bool CollectEntity(b2ShapeId shapeId, void *context)
+{
+    EntityQuery *query = context;
+    void *userData = b2Body_GetUserData(b2Shape_GetBody(shapeId));
+    if (userData == NULL)
+    {
+        return true;
+    }
+
+    int index = UserDataToIndex(query->store, userData);
+    if (index < 0)
+    {
+        return true;
+    }
+
+    // Bodies with several shapes are reported once per shape
+    if (query->marks[index] == 0)
+    {
+        query->marks[index] = 1;
+        query->indices[query->count++] = index;
+    }
+
+    return true;
+}
+
+static int CompareIndices(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+int QueryEntitiesInAABB(const EntityStore *store,
+                        b2WorldId worldId,
+                        b2AABB aabb,
+                        int *indices,
+                        uint8_t *marks)
+{
+    EntityQuery query = {store, indices, marks, 0};
+    b2World_OverlapAABB(worldId, aabb, b2DefaultQueryFilter(), CollectEntity, &query);
+
+    for (int i = 0; i < query.count; ++i)
+    {
+        marks[indices[i]] = 0;
+    }
+
+    qsort(indices, (size_t)query.count, sizeof(int), CompareIndices);
+    return query.count;
+}
+
+void RefreshEntityTransforms(EntityStore *store)
+{
+    for (int i = 0; i < store->count; ++i)
+    {
+        ReadBodyTransform(store, i);
+    }
+}
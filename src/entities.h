@@ -0,0 +1,87 @@
+#ifndef ENTITIES_H
+#define ENTITIES_H
+
+#include "box2d/box2d.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Stable reference to an entity. The generation changes when the slot is reused, so handles to
+// destroyed entities are detected instead of aliasing a newer entity.
+typedef struct EntityHandle
+{
+    uint32_t slot;
+    uint32_t generation;
+} EntityHandle;
+
+// Struct-of-arrays entity storage. Entities are packed in the dense arrays [0, count) so per-frame
+// passes stream through contiguous memory; destroying an entity moves the last one into its place.
+// Handles go through a slot table, which is why they stay valid when entities move.
+typedef struct EntityStore
+{
+    // Dense arrays
+    b2BodyId *bodyIds;
+    int *spriteIds; // index into the sprite frame table
+    float *positionX; // cached body pose in world space
+    float *positionY;
+    float *rotationC;
+    float *rotationS;
+    // Pose before the last step, for entities whose moveSteps entry equals moveStep. The others
+    // did not move during it, so their current pose is also their previous one.
+    float *previousX;
+    float *previousY;
+    float *previousC;
+    float *previousS;
+    uint32_t *moveSteps; // moveStep of the last step that moved the entity
+    uint32_t *slots;     // owning slot of each dense entry
+    int count;
+    int capacity;
+    uint32_t moveStep;
+
+    // Slot table. Free slots form a list threaded through denseIndices.
+    uint32_t *denseIndices;
+    uint32_t *generations;
+    uint32_t freeSlot;
+    int slotCount;
+    int slotCapacity;
+} EntityStore;
+
+EntityStore CreateEntityStore(int capacity);
+void DestroyEntityStore(EntityStore *store);
+
+// Adds an entity for an existing body and caches its current transform. The body user data is
+// set to the entity slot so move events can find the entity. Returns a handle that is never valid
+// and leaves the store unchanged when growing it fails.
+EntityHandle CreateEntity(EntityStore *store, b2BodyId bodyId, int spriteId);
+
+// Removes the entity and clears the body user data. Does not destroy the body, which must still
+// exist.
+void DestroyEntity(EntityStore *store, EntityHandle handle);
+
+bool IsEntityValid(const EntityStore *store, EntityHandle handle);
+
+// Returns the dense index of the entity or -1 if the handle is stale
+int GetEntityIndex(const EntityStore *store, EntityHandle handle);
+
+// Updates the cached poses of the bodies that moved during the last step and keeps their pose from
+// before it. Must be called after every b2World_Step since Box2D only keeps the events of the
+// latest step. Costs one write per moved body, however many entities there are.
+void ApplyBodyMoveEvents(EntityStore *store, b2BodyEvents events);
+
+// Starts a step without moves, for when the world is not stepped. Every entity is then where it was
+// before the step.
+void ClearEntityMoves(EntityStore *store);
+
+// Reads every cached pose back from Box2D
+void RefreshEntityTransforms(EntityStore *store);
+
+// Writes the dense indices of entities with a shape overlapping aabb to indices, in ascending
+// order, and returns how many were written. Both arrays need room for store->count entries and
+// marks must be all zero; it is left that way.
+int QueryEntitiesInAABB(const EntityStore *store,
+                        b2WorldId worldId,
+                        b2AABB aabb,
+                        int *indices,
+                        uint8_t *marks);
+
+#endif // ENTITIES_H
@@ -0,0 +1,183 @@
+#include "framepacer.h"
+#include "thread.h"
+#include "timer.h"
+
+#include <math.h>
+#include <string.h>
+
+// Weight of the newest sample in the overshoot estimate
+#define OVERSHOOT_SMOOTHING 0.1
+
+// Bounds of the spin window. The upper bound covers 1 ms schedulers that overshoot by a full tick.
+#define MIN_SPIN_NANOSECONDS 50000ull
+#define MAX_SPIN_NANOSECONDS 4000000ull
+
+// Short sleeps that seed the overshoot estimate before the first frame, no shorter than the pacer
+// will ever sleep
+#define CALIBRATION_SLEEP_COUNT 5
+#define CALIBRATION_SLEEP_NANOSECONDS                                                             \
+    (TIMER_MIN_SLEEP_NANOSECONDS > 100000ull ? TIMER_MIN_SLEEP_NANOSECONDS : 100000ull)
+
+const int framePacerBucketLimits[FRAME_PACER_HISTOGRAM_BUCKETS - 1] = {
+    10, 50, 100, 250, 500, 1000, 2000};
+
+static void RecordLateness(FramePacerStats *stats, uint64_t lateness)
+{
+    uint64_t microseconds = lateness / 1000ull;
+    int bucket = 0;
+    while (bucket < FRAME_PACER_HISTOGRAM_BUCKETS - 1 &&
+           microseconds >= (uint64_t)framePacerBucketLimits[bucket])
+    {
+        ++bucket;
+    }
+
+    stats->latenessHistogram[bucket] += 1;
+}
+
+static void UpdateSpinThreshold(FramePacer *pacer, uint64_t overshoot)
+{
+    // Exponentially weighted mean and variance
+    double delta = (double)overshoot - pacer->overshootMean;
+    double variance = pacer->overshootVariance + OVERSHOOT_SMOOTHING * delta * delta;
+    pacer->overshootMean += OVERSHOOT_SMOOTHING * delta;
+    pacer->overshootVariance = (1.0 - OVERSHOOT_SMOOTHING) * variance;
+
+    // Spin long enough to absorb nearly all overshoots
+    double threshold = pacer->overshootMean + 3.0 * sqrt(pacer->overshootVariance);
+    if (threshold < MIN_SPIN_NANOSECONDS)
+    {
+        threshold = MIN_SPIN_NANOSECONDS;
+    }
+    else if (threshold > MAX_SPIN_NANOSECONDS)
+    {
+        threshold = MAX_SPIN_NANOSECONDS;
+    }
+
+    pacer->spinThreshold = (uint64_t)threshold;
+}
+
+// Sleeps and feeds the overshoot into the estimate. Returns the time after the sleep.
+static uint64_t MeasuredSleep(FramePacer *pacer, uint64_t request)
+{
+    uint64_t before = TimerNow();
+    TimerSleep(request);
+    uint64_t now = TimerNow();
+    uint64_t slept = now - before;
+    uint64_t overshoot = slept > request ? slept - request : 0;
+
+    // The first sample seeds the mean so the estimate does not have to climb up from zero
+    if (pacer->sleepCount++ == 0)
+    {
+        pacer->overshootMean = (double)overshoot;
+    }
+
+    UpdateSpinThreshold(pacer, overshoot);
+    return now;
+}
+
+FramePacer MakeFramePacer(double periodSeconds, FramePacerMode mode)
+{
+    FramePacer pacer = {0};
+    pacer.mode = mode;
+    pacer.period = (uint64_t)(periodSeconds * 1e9);
+    pacer.spinThreshold = MAX_SPIN_NANOSECONDS;
+
+    // Measure the OS timer up front. Starting from a pessimistic guess instead would leave
+    // periods shorter than the guess spinning every frame, since only sleeps calibrate it.
+    if (mode == FRAME_PACER_HYBRID)
+    {
+        for (int i = 0; i < CALIBRATION_SLEEP_COUNT; ++i)
+        {
+            MeasuredSleep(&pacer, CALIBRATION_SLEEP_NANOSECONDS);
+        }
+    }
+
+    return pacer;
+}
+
+// The spin window never covers more than half the period. A window wider than the frame would never
+// sleep again and so never measure the smaller overshoot that would shrink it, leaving short
+// periods spinning for good after one slow wake up.
+static uint64_t GetSpinWindow(const FramePacer *pacer)
+{
+    uint64_t limit = pacer->period / 2;
+    return pacer->spinThreshold < limit ? pacer->spinThreshold : limit;
+}
+
+void SetFramePacerPeriod(FramePacer *pacer, double periodSeconds)
+{
+    pacer->period = (uint64_t)(periodSeconds * 1e9);
+}
+
+void WaitForNextFrame(FramePacer *pacer)
+{
+    uint64_t now = TimerNow();
+    if (pacer->deadline == 0)
+    {
+        pacer->deadline = now + pacer->period;
+        return;
+    }
+
+    pacer->stats.frameCount += 1;
+
+    if (now >= pacer->deadline)
+    {
+        pacer->stats.missedDeadlines += 1;
+        RecordLateness(&pacer->stats, now - pacer->deadline);
+        pacer->deadline = now + pacer->period;
+        return;
+    }
+
+    uint64_t deadline = pacer->deadline;
+    uint64_t spinThreshold = 0;
+    if (pacer->mode == FRAME_PACER_HYBRID)
+    {
+        spinThreshold = GetSpinWindow(pacer);
+    }
+    else if (pacer->mode == FRAME_PACER_SPIN)
+    {
+        spinThreshold = UINT64_MAX;
+    }
+
+    // Coarse sleeps while the remaining time exceeds the expected overshoot
+    uint64_t sleepStart = now;
+    while (now < deadline && deadline - now > spinThreshold)
+    {
+        uint64_t request = deadline - now - (pacer->mode == FRAME_PACER_HYBRID ? spinThreshold : 0);
+        if (pacer->mode == FRAME_PACER_HYBRID && request < TIMER_MIN_SLEEP_NANOSECONDS)
+        {
+            // Too short for the OS timer, the sleep would return late or not at all
+            break;
+        }
+
+        now = MeasuredSleep(pacer, request);
+        if (pacer->mode == FRAME_PACER_HYBRID)
+        {
+            spinThreshold = GetSpinWindow(pacer);
+        }
+    }
+    pacer->stats.sleepSeconds += TimerSeconds(sleepStart, now);
+
+    // Spin out the rest
+    uint64_t spinStart = now;
+    while (now < deadline)
+    {
+        ThreadPause();
+        now = TimerNow();
+    }
+    pacer->stats.spinSeconds += TimerSeconds(spinStart, now);
+
+    RecordLateness(&pacer->stats, now - deadline);
+
+    // Keep a fixed cadence unless a late wake up already ate into the next frame
+    pacer->deadline = deadline + pacer->period;
+    if (pacer->deadline <= now)
+    {
+        pacer->deadline = now + pacer->period;
+    }
+}
+
+void ResetFramePacerStats(FramePacer *pacer)
+{
+    memset(&pacer->stats, 0, sizeof(FramePacerStats));
+}
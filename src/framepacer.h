@@ -0,0 +1,55 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <stdint.h>
+
+#define FRAME_PACER_HISTOGRAM_BUCKETS 8
+
+// Upper bounds of the lateness histogram buckets in microseconds. The last bucket is unbounded.
+extern const int framePacerBucketLimits[FRAME_PACER_HISTOGRAM_BUCKETS - 1];
+
+typedef enum FramePacerMode
+{
+    FRAME_PACER_HYBRID, // sleep most of the wait, spin the calibrated remainder
+    FRAME_PACER_SLEEP,  // sleep the whole wait, cheapest but late by the OS timer granularity
+    FRAME_PACER_SPIN,   // spin the whole wait, most precise but burns a core
+} FramePacerMode;
+
+typedef struct FramePacerStats
+{
+    uint64_t frameCount;
+    uint64_t missedDeadlines; // frames whose work alone overran the period
+    uint64_t latenessHistogram[FRAME_PACER_HISTOGRAM_BUCKETS]; // wake up time past the deadline
+    double sleepSeconds;
+    double spinSeconds;
+} FramePacerStats;
+
+// Holds the frame loop to a fixed period. Sleep overshoot is measured by probe sleeps at creation
+// and then on every sleep, and the spin window tracks it, so the pacer adapts to the OS timer
+// instead of assuming 1 ms.
+typedef struct FramePacer
+{
+    FramePacerMode mode;
+    uint64_t period;   // nanoseconds
+    uint64_t deadline; // end of the current frame, 0 before the first wait
+
+    // Running estimate of how far a sleep overshoots its request
+    double overshootMean;
+    double overshootVariance;
+    uint64_t sleepCount;
+    uint64_t spinThreshold;
+
+    FramePacerStats stats;
+} FramePacer;
+
+FramePacer MakeFramePacer(double periodSeconds, FramePacerMode mode);
+
+void SetFramePacerPeriod(FramePacer *pacer, double periodSeconds);
+
+// Waits for the end of the current frame period and starts the next one. A frame that already
+// overran counts as missed and the schedule restarts from now instead of bursting to catch up.
+void WaitForNextFrame(FramePacer *pacer);
+
+void ResetFramePacerStats(FramePacer *pacer);
+
+#endif // FRAMEPACER_H
@@ -0,0 +1,445 @@
+#include "jobs.h"
+#include "profiler.h"
+#include "thread.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define JOB_QUEUE_CAPACITY 1024
+#define JOB_TASK_CAPACITY 256
+#define JOB_SPIN_COUNT 2000
+
+typedef struct Job
+{
+    JobTask *task;
+    int32_t startIndex;
+    int32_t endIndex;
+} Job;
+
+struct JobTask
+{
+    JobFunc *func;
+    void *context;
+    int32_t minRange;
+    atomic_int remaining;
+    atomic_bool inUse;
+};
+
+// Ring buffer deque guarded by a spin lock. The owning worker pushes and pops at the bottom,
+// thieves take from the top. The indices are unsigned so they wrap around instead of overflowing;
+// the capacity is a power of two, so the ring position stays correct across the wrap.
+typedef struct JobQueue
+{
+    atomic_flag lock;
+    uint32_t top;
+    uint32_t bottom;
+    Job jobs[JOB_QUEUE_CAPACITY];
+} JobQueue;
+
+typedef struct WorkerContext
+{
+    JobSystem *jobSystem;
+    int workerIndex;
+} WorkerContext;
+
+struct JobSystem
+{
+    // Lowered if a worker thread cannot be started, while earlier workers may already be reading it
+    atomic_int workerCount;
+    JobQueue *queues;
+    Thread **threads;
+    WorkerContext *workerContexts;
+    JobTask tasks[JOB_TASK_CAPACITY];
+    atomic_uint taskCursor;
+
+    // Identifies the owner thread by the address of its thread local token
+    _Atomic(const int *) owner;
+
+    Mutex *sleepMutex;
+    Condition *sleepCondition;
+    atomic_int queuedJobs;
+    atomic_int sleepingCount;
+    atomic_bool quit;
+};
+
+static _Thread_local int threadToken;
+static _Thread_local JobSystem *currentJobSystem;
+static _Thread_local int currentWorkerIndex;
+
+static void LockQueue(JobQueue *queue)
+{
+    while (atomic_flag_test_and_set_explicit(&queue->lock, memory_order_acquire))
+    {
+        ThreadPause();
+    }
+}
+
+static void UnlockQueue(JobQueue *queue)
+{
+    atomic_flag_clear_explicit(&queue->lock, memory_order_release);
+}
+
+static bool PushJob(JobQueue *queue, Job job)
+{
+    LockQueue(queue);
+    bool pushed = queue->bottom - queue->top < JOB_QUEUE_CAPACITY;
+    if (pushed)
+    {
+        queue->jobs[queue->bottom % JOB_QUEUE_CAPACITY] = job;
+        queue->bottom += 1;
+    }
+    UnlockQueue(queue);
+    return pushed;
+}
+
+static bool PopJob(JobQueue *queue, Job *job)
+{
+    LockQueue(queue);
+    bool popped = queue->bottom != queue->top;
+    if (popped)
+    {
+        queue->bottom -= 1;
+        *job = queue->jobs[queue->bottom % JOB_QUEUE_CAPACITY];
+    }
+    UnlockQueue(queue);
+    return popped;
+}
+
+static bool StealJob(JobQueue *queue, Job *job)
+{
+    LockQueue(queue);
+    bool stolen = queue->bottom != queue->top;
+    if (stolen)
+    {
+        *job = queue->jobs[queue->top % JOB_QUEUE_CAPACITY];
+        queue->top += 1;
+    }
+    UnlockQueue(queue);
+    return stolen;
+}
+
+// Returns the worker index of the calling thread, or -1 if it may not execute jobs
+static int GetWorkerIndex(JobSystem *jobSystem)
+{
+    if (currentJobSystem == jobSystem)
+    {
+        return currentWorkerIndex;
+    }
+
+    if (atomic_load_explicit(&jobSystem->owner, memory_order_relaxed) == &threadToken)
+    {
+        return 0;
+    }
+
+    return -1;
+}
+
+static void WakeWorker(JobSystem *jobSystem)
+{
+    atomic_fetch_add(&jobSystem->queuedJobs, 1);
+    if (atomic_load(&jobSystem->sleepingCount) > 0)
+    {
+        MutexLock(jobSystem->sleepMutex);
+        ConditionSignal(jobSystem->sleepCondition);
+        MutexUnlock(jobSystem->sleepMutex);
+    }
+}
+
+static bool TryGetJob(JobSystem *jobSystem, int workerIndex, Job *job)
+{
+    if (PopJob(jobSystem->queues + workerIndex, job))
+    {
+        atomic_fetch_sub(&jobSystem->queuedJobs, 1);
+        return true;
+    }
+
+    int workerCount = atomic_load_explicit(&jobSystem->workerCount, memory_order_relaxed);
+    for (int i = 1; i < workerCount; ++i)
+    {
+        int victim = (workerIndex + i) % workerCount;
+        if (StealJob(jobSystem->queues + victim, job))
+        {
+            atomic_fetch_sub(&jobSystem->queuedJobs, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void ExecuteJob(JobSystem *jobSystem, int workerIndex, Job job)
+{
+    JobTask *task = job.task;
+
+    // Split off the upper half for other workers while the range is worth sharing
+    while (job.endIndex - job.startIndex >= 2 * task->minRange)
+    {
+        int32_t midIndex = job.startIndex + (job.endIndex - job.startIndex) / 2;
+        Job upper = {task, midIndex, job.endIndex};
+        if (!PushJob(jobSystem->queues + workerIndex, upper))
+        {
+            break;
+        }
+
+        WakeWorker(jobSystem);
+        job.endIndex = midIndex;
+    }
+
+    PROFILE_ZONE_BEGIN(jobZone, "job");
+    task->func(job.startIndex, job.endIndex, (uint32_t)workerIndex, task->context);
+    PROFILE_ZONE_END(jobZone);
+
+    atomic_fetch_sub_explicit(&task->remaining,
+                              job.endIndex - job.startIndex,
+                              memory_order_release);
+}
+
+static void WorkerMain(void *context)
+{
+    WorkerContext *workerContext = context;
+    JobSystem *jobSystem = workerContext->jobSystem;
+    int workerIndex = workerContext->workerIndex;
+
+    currentJobSystem = jobSystem;
+    currentWorkerIndex = workerIndex;
+
+#if defined(ENABLE_PROFILER)
+    char threadName[32];
+    snprintf(threadName, sizeof(threadName), "worker %d", workerIndex);
+    ProfilerSetThreadName(threadName);
+#endif
+
+    int spinCount = 0;
+    while (!atomic_load(&jobSystem->quit))
+    {
+        Job job;
+        if (TryGetJob(jobSystem, workerIndex, &job))
+        {
+            ExecuteJob(jobSystem, workerIndex, job);
+            spinCount = 0;
+            continue;
+        }
+
+        if (++spinCount < JOB_SPIN_COUNT)
+        {
+            ThreadPause();
+            continue;
+        }
+
+        // Sleep until a job is queued. The counters are sequentially consistent so a push racing
+        // with this check either sees the sleeper or is seen by it.
+        MutexLock(jobSystem->sleepMutex);
+        atomic_fetch_add(&jobSystem->sleepingCount, 1);
+        while (atomic_load(&jobSystem->queuedJobs) == 0 && !atomic_load(&jobSystem->quit))
+        {
+            ConditionWait(jobSystem->sleepCondition, jobSystem->sleepMutex);
+        }
+        atomic_fetch_sub(&jobSystem->sleepingCount, 1);
+        MutexUnlock(jobSystem->sleepMutex);
+        spinCount = 0;
+    }
+
+    currentJobSystem = NULL;
+    PROFILE_RELEASE_THREAD();
+}
+
+JobSystem *JobSystemCreate(int workerCount)
+{
+    if (workerCount < 1)
+    {
+        workerCount = 1;
+    }
+    else if (workerCount > b2_maxWorkers)
+    {
+        workerCount = b2_maxWorkers;
+    }
+
+    JobSystem *jobSystem = calloc(1, sizeof(JobSystem));
+    atomic_init(&jobSystem->workerCount, workerCount);
+    jobSystem->queues = calloc((size_t)workerCount, sizeof(JobQueue));
+    jobSystem->threads = calloc((size_t)workerCount, sizeof(Thread *));
+    jobSystem->workerContexts = calloc((size_t)workerCount, sizeof(WorkerContext));
+    jobSystem->sleepMutex = MutexCreate();
+    jobSystem->sleepCondition = ConditionCreate();
+
+    for (int i = 0; i < workerCount; ++i)
+    {
+        atomic_flag_clear(&jobSystem->queues[i].lock);
+    }
+
+    for (int i = 0; i < JOB_TASK_CAPACITY; ++i)
+    {
+        atomic_init(&jobSystem->tasks[i].remaining, 0);
+        atomic_init(&jobSystem->tasks[i].inUse, false);
+    }
+
+    atomic_init(&jobSystem->taskCursor, 0);
+    atomic_init(&jobSystem->owner, &threadToken);
+    atomic_init(&jobSystem->queuedJobs, 0);
+    atomic_init(&jobSystem->sleepingCount, 0);
+    atomic_init(&jobSystem->quit, false);
+
+    // Worker 0 is the owner thread, only the others get a thread of their own
+    for (int i = 1; i < workerCount; ++i)
+    {
+        jobSystem->workerContexts[i] = (WorkerContext){jobSystem, i};
+        jobSystem->threads[i] = ThreadCreate(WorkerMain, jobSystem->workerContexts + i);
+        if (jobSystem->threads[i] == NULL)
+        {
+            // Carry on with the workers that did start. Nothing is ever queued for the missing
+            // ones since workers only push to their own queue.
+            atomic_store(&jobSystem->workerCount, i);
+            break;
+        }
+    }
+
+    return jobSystem;
+}
+
+void JobSystemDestroy(JobSystem *jobSystem)
+{
+    MutexLock(jobSystem->sleepMutex);
+    atomic_store(&jobSystem->quit, true);
+    ConditionBroadcast(jobSystem->sleepCondition);
+    MutexUnlock(jobSystem->sleepMutex);
+
+    int workerCount = atomic_load(&jobSystem->workerCount);
+    for (int i = 1; i < workerCount; ++i)
+    {
+        if (jobSystem->threads[i] != NULL)
+        {
+            ThreadJoin(jobSystem->threads[i]);
+        }
+    }
+
+    ConditionDestroy(jobSystem->sleepCondition);
+    MutexDestroy(jobSystem->sleepMutex);
+    free(jobSystem->workerContexts);
+    free(jobSystem->threads);
+    free(jobSystem->queues);
+    free(jobSystem);
+}
+
+int JobSystemGetWorkerCount(const JobSystem *jobSystem)
+{
+    return atomic_load(&((JobSystem *)jobSystem)->workerCount);
+}
+
+void JobSystemSetOwner(JobSystem *jobSystem)
+{
+    atomic_store(&jobSystem->owner, &threadToken);
+}
+
+// Returns NULL when every task slot is in use
+static JobTask *AcquireTask(JobSystem *jobSystem)
+{
+    for (int attempt = 0; attempt < JOB_TASK_CAPACITY; ++attempt)
+    {
+        unsigned index = atomic_fetch_add_explicit(&jobSystem->taskCursor, 1, memory_order_relaxed);
+        JobTask *task = jobSystem->tasks + index % JOB_TASK_CAPACITY;
+        if (!atomic_exchange_explicit(&task->inUse, true, memory_order_acquire))
+        {
+            return task;
+        }
+    }
+
+    return NULL;
+}
+
+JobTask *JobSystemParallelFor(JobSystem *jobSystem,
+                              JobFunc *func,
+                              int32_t itemCount,
+                              int32_t minRange,
+                              void *context)
+{
+    if (itemCount <= 0)
+    {
+        return NULL;
+    }
+
+    int workerIndex = GetWorkerIndex(jobSystem);
+    if (minRange < 1)
+    {
+        minRange = 1;
+    }
+
+    // Small tasks are still queued: Box2D submits each solver task as a single item and the
+    // solver only runs in parallel if those tasks reach other workers
+    JobTask *task = JobSystemGetWorkerCount(jobSystem) > 1 ? AcquireTask(jobSystem) : NULL;
+    if (task == NULL)
+    {
+        func(0, itemCount, workerIndex > 0 ? (uint32_t)workerIndex : 0, context);
+        return NULL;
+    }
+
+    task->func = func;
+    task->context = context;
+    task->minRange = minRange;
+    atomic_store_explicit(&task->remaining, itemCount, memory_order_relaxed);
+
+    Job job = {task, 0, itemCount};
+    JobQueue *queue = jobSystem->queues + (workerIndex > 0 ? workerIndex : 0);
+    if (!PushJob(queue, job))
+    {
+        // Queue full, run it here rather than fail
+        func(0, itemCount, workerIndex > 0 ? (uint32_t)workerIndex : 0, context);
+        atomic_store_explicit(&task->inUse, false, memory_order_release);
+        return NULL;
+    }
+
+    WakeWorker(jobSystem);
+    return task;
+}
+
+void JobSystemWait(JobSystem *jobSystem, JobTask *task)
+{
+    if (task == NULL)
+    {
+        return;
+    }
+
+    int workerIndex = GetWorkerIndex(jobSystem);
+    while (atomic_load_explicit(&task->remaining, memory_order_acquire) > 0)
+    {
+        Job job;
+        if (workerIndex < 0)
+        {
+            ThreadYield();
+        }
+        else if (TryGetJob(jobSystem, workerIndex, &job))
+        {
+            ExecuteJob(jobSystem, workerIndex, job);
+        }
+        else
+        {
+            ThreadPause();
+        }
+    }
+
+    atomic_store_explicit(&task->inUse, false, memory_order_release);
+}
+
+static void *EnqueueBox2DTask(b2TaskCallback *task,
+                              int32_t itemCount,
+                              int32_t minRange,
+                              void *taskContext,
+                              void *userContext)
+{
+    return JobSystemParallelFor(userContext, task, itemCount, minRange, taskContext);
+}
+
+static void FinishBox2DTask(void *userTask, void *userContext)
+{
+    JobSystemWait(userContext, userTask);
+}
+
+void JobSystemConfigureWorld(JobSystem *jobSystem, b2WorldDef *worldDef)
+{
+    worldDef->workerCount = JobSystemGetWorkerCount(jobSystem);
+    worldDef->enqueueTask = EnqueueBox2DTask;
+    worldDef->finishTask = FinishBox2DTask;
+    worldDef->userTaskContext = jobSystem;
+}
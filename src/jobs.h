@@ -0,0 +1,45 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include "box2d/box2d.h"
+
+#include <stdint.h>
+
+// Work-stealing job system. Each worker owns a deque of ranges: it pops its newest work and idle
+// workers steal the oldest work of others. Ranges are split in half lazily when a worker picks them
+// up, so big tasks spread across all workers while small ones stay on a single core.
+//
+// Worker 0 is the owner thread, which is the thread that created the system unless changed with
+// JobSystemSetOwner. Only the owner and the background workers help execute jobs while waiting;
+// any other thread may submit work but waits passively.
+
+typedef struct JobSystem JobSystem;
+typedef struct JobTask JobTask;
+
+// Same signature as b2TaskCallback so Box2D tasks run without a trampoline
+typedef void JobFunc(int32_t startIndex, int32_t endIndex, uint32_t workerIndex, void *context);
+
+// workerCount includes the owner thread, so 1 runs every job inline
+JobSystem *JobSystemCreate(int workerCount);
+void JobSystemDestroy(JobSystem *jobSystem);
+
+int JobSystemGetWorkerCount(const JobSystem *jobSystem);
+
+// Makes the calling thread worker 0. The previous owner must no longer be waiting on tasks.
+void JobSystemSetOwner(JobSystem *jobSystem);
+
+// Runs func over [0, itemCount) in ranges of at least minRange items. Returns NULL when the work
+// already completed inline, otherwise a task that must be passed to JobSystemWait.
+JobTask *JobSystemParallelFor(JobSystem *jobSystem,
+                              JobFunc *func,
+                              int32_t itemCount,
+                              int32_t minRange,
+                              void *context);
+
+// Blocks until every range of the task has run. Accepts NULL.
+void JobSystemWait(JobSystem *jobSystem, JobTask *task);
+
+// Routes the Box2D solver, broadphase and island tasks of a world through the job system
+void JobSystemConfigureWorld(JobSystem *jobSystem, b2WorldDef *worldDef);
+
+#endif // JOBS_H
@@ -1,45 +1,40 @@
 #if defined(PLATFORM_DESKTOP) && defined(GRAPHICS_API_OPENGL_ES2)
 #include "GLFW/glfw3.h"
 #endif
+#include "assets.h"
 #include "box2d/box2d.h"
+#include "entities.h"
+#include "framepacer.h"
+#include "jobs.h"
+#include "physics_thread.h"
+#include "profiler.h"
+#include "profiler_overlay.h"
 #include "raylib.h"
 #include "raymath.h"
+#include "scene.h"
+#include "spritebatch.h"
+#include "thread.h"
+#include "timer.h"
 #include <stdio.h>
 
-typedef struct Conversion
-{
-    float scale;
-    float tileSize;
-    float screenWidth;
-    float screenHeight;
-} Conversion;
-
-typedef struct Entity
-{
-    b2BodyId bodyId;
-    Texture texture;
-} Entity;
+#ifndef ASSETS_PATH
+#define ASSETS_PATH "assets/"
+#endif
 
-Vector2 ConvertWorldToScreen(b2Vec2 p, Conversion cv)
-{
-    Vector2 result = {cv.scale * p.x + 0.5f * cv.screenWidth,
-                      0.5f * cv.screenHeight - cv.scale * p.y};
-    return result;
-}
+// Loose images loaded when the asset pack at ASSETS_PATH cannot be. Only Debug builds have them.
+#ifndef ASSETS_FALLBACK_PATH
+#define ASSETS_FALLBACK_PATH NULL
+#endif
 
-void DrawEntity(const Entity *entity, Conversion cv)
+// Sprite ids, in the order of spriteNames
+enum
 {
-    b2Vec2 p =
-        b2Body_GetWorldPoint(entity->bodyId, (b2Vec2){-0.5f * cv.tileSize, 0.5f * cv.tileSize});
-    float radians = b2Body_GetAngle(entity->bodyId);
-
-    Vector2 ps = ConvertWorldToScreen(p, cv);
+    SPRITE_GROUND,
+    SPRITE_BOX,
+    SPRITE_COUNT
+};
 
-    float textureScale = cv.tileSize * cv.scale / (float)entity->texture.width;
-
-    // Have to negate rotation to account for y-flip
-    DrawTextureEx(entity->texture, ps, -RAD2DEG * radians, textureScale, WHITE);
-}
+static const char *const spriteNames[SPRITE_COUNT] = {"ground", "box"};
 
 int main(void)
 {
@@ -56,66 +51,105 @@ int main(void)
     SetConfigFlags(FLAG_VSYNC_HINT);
     InitWindow(screenWidth, screenHeight, "raylib box2d - custom frame control");
 
-    bool pause = false; // Pause control flag
+    bool pause = false;        // Pause control flag
+    bool showProfiler = false; // Replaces the FPS text with per-phase timings
     int targetFPS = 60;
 
     double timeCounter = 0.0;
     float fixedFPS = 60.0f;
     float maxFPS = 1200.0f;
-    double fixedTimeStep = 1.0f / fixedFPS;
-    double maxTimeStep = 1.0f / maxFPS;
+    FixedStep fixedStep = MakeFixedStep(fixedFPS, 4);
+
+    // Limits the frame rate to avoid 100% CPU usage
+    FramePacer framePacer = MakeFramePacer(1.0 / maxFPS, FRAME_PACER_HYBRID);
+
+    // Physics runs on its own thread and rendering interpolates between its steps, so heavy scenes
+    // can drop this to 30 without stuttering
+    float physicsFPS = 60.0f;
 
     double currentTime = GetTime();
-    double accumulator = 0.0;
 
-    float position = 0.0f; // Circle position
+    float position = 0.0f;         // Circle position
+    float previousPosition = 0.0f; // Circle position before the last fixed update
+    double alpha = 0.0;            // Left over time as a fraction of a fixed update
 
     float tileSize = 1.0f;
     float scale = 50.0f;
 
-    Conversion cv = {scale, tileSize, (float)screenWidth, (float)screenHeight};
+    Conversion cv = {scale, tileSize, (float)screenWidth, (float)screenHeight, {0.0f, 0.0f}};
+
+    // Threads used to step the world, including this one
+    int workerCount = GetCoreCount() < 8 ? GetCoreCount() : 8;
+    JobSystem *jobSystem = JobSystemCreate(workerCount);
 
     b2WorldDef worldDef = b2DefaultWorldDef();
+    JobSystemConfigureWorld(jobSystem, &worldDef);
     b2WorldId worldId = b2CreateWorld(&worldDef);
 
-    Texture2D textures[2] = {0};
-    textures[0] = LoadTexture("assets/ground.png");
-    textures[1] = LoadTexture("assets/box.png");
-
-    b2Polygon tilePolygon = b2MakeSquare(0.5f * tileSize);
-
-    Entity groundEntities[20] = {0};
-    for (int i = 0; i < 20; ++i)
+    // ASSETS_PATH is the cooked archive, or a directory of loose images when cooking is disabled
+    GameAssets assets =
+        LoadGameAssets(ASSETS_PATH, ASSETS_FALLBACK_PATH, spriteNames, SPRITE_COUNT);
+    if (assets.pageCount == 0)
     {
-        Entity *entity = groundEntities + i;
-        b2BodyDef bodyDef = b2DefaultBodyDef();
-        bodyDef.position = (b2Vec2){(1.0f * i - 10.0f) * tileSize, -4.5f - 0.5f * tileSize};
-
-        // I used this rotation to test the world to screen transformation
-        bodyDef.angle = 0.25f * b2_pi * i;
-
-        entity->bodyId = b2CreateBody(worldId, &bodyDef);
-        entity->texture = textures[0];
-        b2ShapeDef shapeDef = b2DefaultShapeDef();
-        b2CreatePolygonShape(entity->bodyId, &shapeDef, &tilePolygon);
+        TraceLog(LOG_ERROR, "ASSETS: No sprites could be loaded from %s", ASSETS_PATH);
+        UnloadGameAssets(&assets);
+        b2DestroyWorld(worldId);
+        JobSystemDestroy(jobSystem);
+        CloseWindow();
+        return 1;
     }
 
-    Entity boxEntities[4] = {4};
-    for (int i = 0; i < 4; ++i)
+    // The level is a long row of chunks. Only those around the camera have bodies.
+    SceneChunkDef chunkDef = {0};
+    chunkDef.tileSize = tileSize;
+    chunkDef.tilesPerChunk = 16;
+    chunkDef.boxesPerChunk = 8;
+    chunkDef.stackHeight = 4;
+    chunkDef.groundSprite = SPRITE_GROUND;
+    chunkDef.boxSprite = SPRITE_BOX;
+
+    WorldStreamDef streamDef = DefaultWorldStreamDef();
+    streamDef.generator = GenerateSceneChunk;
+    streamDef.generatorContext = &chunkDef;
+    streamDef.chunkSize = (float)chunkDef.tilesPerChunk * tileSize;
+    streamDef.chunkCountX = 256;
+    streamDef.origin = (b2Vec2){-0.5f * (float)streamDef.chunkCountX * streamDef.chunkSize,
+                                -0.5f * streamDef.chunkSize};
+    streamDef.tileSize = tileSize;
+    chunkDef.origin = streamDef.origin;
+
+    // Bodies outside the view can move into it before the next snapshot
+    float viewPadding = 2.0f * tileSize;
+
+    EntityStore entities = CreateEntityStore(1024);
+    WorldStream *worldStream = CreateWorldStream(worldId, &entities, &streamDef);
+    FlushWorldStream(worldStream, cv.camera);
+
+    SpriteBatch spriteBatch = CreateSpriteBatch(entities.count);
+    InterpolatedPoses poses = {0};
+
+    // From here on the physics thread owns the world, the stream and the entities
+    PhysicsThreadDef physicsDef = {0};
+    physicsDef.worldId = worldId;
+    physicsDef.entities = &entities;
+    physicsDef.jobSystem = jobSystem;
+    physicsDef.stream = worldStream;
+    physicsDef.fixedTimeStep = 1.0 / physicsFPS;
+    physicsDef.subStepCount = 4;
+    PhysicsThread *physics = StartPhysicsThread(&physicsDef);
+    int exitCode = 0;
+    if (physics == NULL)
     {
-        Entity *entity = boxEntities + i;
-        b2BodyDef bodyDef = b2DefaultBodyDef();
-        bodyDef.type = b2_dynamicBody;
-        bodyDef.position = (b2Vec2){0.5f * tileSize * i, -4.0f + tileSize * i};
-        entity->bodyId = b2CreateBody(worldId, &bodyDef);
-        entity->texture = textures[1];
-        b2ShapeDef shapeDef = b2DefaultShapeDef();
-        shapeDef.restitution = 0.1f;
-        b2CreatePolygonShape(entity->bodyId, &shapeDef, &tilePolygon);
+        TraceLog(LOG_ERROR, "PHYSICS: Failed to start the physics thread");
+        exitCode = 1;
     }
 
-    while (!WindowShouldClose())
+    PROFILE_THREAD_NAME("main");
+
+    while (physics != NULL && !WindowShouldClose())
     {
+        PROFILE_ZONE_BEGIN(frameZone, "frame");
+
         // Update
         //----------------------------------------------------------------------------------
 
@@ -130,84 +164,183 @@ int main(void)
 
         currentTime = newTime;
 
-        // Limit frame rate to avoid 100% CPU usage
-        if (frameTime < maxTimeStep)
-        {
-            float waitTime = (float)(maxTimeStep - frameTime);
-            WaitTime(1.0f / 1000.0f);
-        }
-
-
         // Input
         //----------------------------------------------------------------------------------
+        PROFILE_ZONE_BEGIN(inputZone, "input");
         PollInputEvents(); // Poll input events (SUPPORT_CUSTOM_FRAME_CONTROL)
 
         if (IsKeyPressed(KEY_SPACE))
         {
             pause = !pause;
+            SetPhysicsPaused(physics, pause);
+        }
+
+        if (IsKeyPressed(KEY_F1))
+        {
+            showProfiler = !showProfiler;
         }
 
+        if (IsKeyPressed(KEY_F2))
+        {
+            PROFILE_EXPORT_TRACE("trace.json");
+        }
+
+        float cameraStep = 20.0f * tileSize * (float)frameTime;
+        cv.camera.x += IsKeyDown(KEY_RIGHT) ? cameraStep : 0.0f;
+        cv.camera.x -= IsKeyDown(KEY_LEFT) ? cameraStep : 0.0f;
+        cv.camera.y += IsKeyDown(KEY_UP) ? cameraStep : 0.0f;
+        cv.camera.y -= IsKeyDown(KEY_DOWN) ? cameraStep : 0.0f;
+
+        // Streaming and culling follow the view on the physics thread
+        b2AABB view = GetConversionView(cv);
+        view.lowerBound.x -= viewPadding;
+        view.lowerBound.y -= viewPadding;
+        view.upperBound.x += viewPadding;
+        view.upperBound.y += viewPadding;
+        SetPhysicsView(physics, view);
+        PROFILE_ZONE_END(inputZone);
+
+        PROFILE_ZONE_BEGIN(fixedZone, "fixed update");
         if (!pause)
         {
-            accumulator += frameTime;
+            FixedStepAdvance(&fixedStep, frameTime);
 
-            while (accumulator >= fixedTimeStep)
+            while (FixedStepConsume(&fixedStep))
             {
                 // Fixed Update
                 //--------------------------------------------------------------------------
 
-                position += (float)(200 * fixedTimeStep); // We move at 200 pixels per second
+                // We move at 200 pixels per second
+                previousPosition = position;
+                position += (float)(200 * fixedStep.fixedTimeStep);
                 if (position >= (float)GetScreenWidth())
+                {
+                    // Jump back without sweeping across the screen
                     position = 0;
-                timeCounter += fixedTimeStep; // We count time (seconds)
-                b2World_Step(worldId, (float)fixedTimeStep, 4);
-
-                timeCounter += fixedTimeStep;
-                accumulator -= fixedTimeStep;
+                    previousPosition = 0;
+                }
+                timeCounter += fixedStep.fixedTimeStep; // We count time (seconds)
             }
 
-            // Left over time to be used for interpolation within Update
-            const double alpha = accumulator / fixedTimeStep;
+            // Left over time to be used for interpolation when drawing
+            alpha = FixedStepAlpha(&fixedStep);
         }
+        PROFILE_ZONE_END(fixedZone);
 
         // Drawing
         //----------------------------------------------------------------------------------
 
+        // Blend the last two physics steps by the time elapsed since the newest one
+        PROFILE_ZONE_BEGIN(interpolateZone, "interpolate");
+        const PoseSnapshot *snapshot = AcquirePhysicsSnapshot(physics);
+        float physicsAlpha = GetSnapshotAlpha(snapshot, physicsDef.fixedTimeStep, TimerNow());
+        InterpolateSnapshot(snapshot, physicsAlpha, &poses);
+        PROFILE_ZONE_END(interpolateZone);
+
+        PROFILE_ZONE_BEGIN(batchZone, "sprite batch");
+        SpriteInstances instances = {poses.positionX,
+                                     poses.positionY,
+                                     poses.rotationC,
+                                     poses.rotationS,
+                                     snapshot->spriteIds,
+                                     poses.count};
+        BuildSpriteBatch(&spriteBatch,
+                         &instances,
+                         assets.frames,
+                         assets.frameCount,
+                         assets.pageCount,
+                         cv);
+        PROFILE_ZONE_END(batchZone);
+
+        PROFILE_ZONE_BEGIN(drawZone, "draw submission");
         BeginDrawing();
 
         ClearBackground(GRAY);
         // Draw
-        for (int i = 0; i < 20; ++i)
+        DrawSpriteBatch(&spriteBatch, assets.pageTextureIds);
+
+        float circleX = previousPosition + (float)alpha * (position - previousPosition);
+        DrawCircle((int)circleX, GetScreenHeight() / 2, 50, RED);
+        DrawText("PRESS SPACE to PAUSE MOVEMENT", 20, GetScreenHeight() - 40, 20, WHITE);
+        DrawText("F1 PROFILER", 20, GetScreenHeight() - 70, 20, WHITE);
+        DrawText("ARROWS to MOVE CAMERA", 20, GetScreenHeight() - 100, 20, WHITE);
+
+        if (showProfiler)
         {
-            DrawEntity(groundEntities + i, cv);
+            DrawProfilerOverlay(GetScreenWidth() - 540, 20, frameTime);
         }
-
-        for (int i = 0; i < 4; ++i)
+        else
         {
-            DrawEntity(boxEntities + i, cv);
+            DrawText(
+                TextFormat("Fixed FPS: %i", (int)fixedFPS), GetScreenWidth() - 200, 20, 20, GREEN);
+            DrawText(TextFormat("Current FPS: %i", (int)(1.0 / frameTime)),
+                     GetScreenWidth() - 200,
+                     40,
+                     20,
+                     GREEN);
+            DrawText(TextFormat("Physics FPS: %i", (int)physicsFPS),
+                     GetScreenWidth() - 200,
+                     60,
+                     20,
+                     GREEN);
+            DrawText(TextFormat("Missed frames: %i", (int)framePacer.stats.missedDeadlines),
+                     GetScreenWidth() - 200,
+                     80,
+                     20,
+                     GREEN);
+            DrawText(TextFormat("Bodies: %i", snapshot->stream.liveBodyCount),
+                     GetScreenWidth() - 200,
+                     100,
+                     20,
+                     GREEN);
+            DrawText(TextFormat("Drawn: %i", snapshot->count),
+                     GetScreenWidth() - 200,
+                     120,
+                     20,
+                     GREEN);
+            DrawText(TextFormat("Stream: %.2f ms", snapshot->stream.updateMs),
+                     GetScreenWidth() - 200,
+                     140,
+                     20,
+                     GREEN);
+            DrawText(TextFormat("Stream max: %.2f ms", snapshot->stream.maxUpdateMs),
+                     GetScreenWidth() - 200,
+                     160,
+                     20,
+                     GREEN);
         }
 
-        DrawCircle((int)position, GetScreenHeight() / 2, 50, RED);
-        DrawText("PRESS SPACE to PAUSE MOVEMENT", 20, GetScreenHeight() - 40, 20, WHITE);
-        DrawText(TextFormat("Fixed FPS: %i", (int)fixedFPS), GetScreenWidth() - 200, 20, 20, GREEN);
-        DrawText(TextFormat("Current FPS: %i", (int)(1.0 / frameTime)),
-                 GetScreenWidth() - 200,
-                 40,
-                 20,
-                 GREEN);
-
         EndDrawing();
+        PROFILE_ZONE_END(drawZone);
 
+        PROFILE_ZONE_BEGIN(swapZone, "SwapScreenBuffer");
         SwapScreenBuffer(); // Flip the back buffer to screen (front buffer)
+        PROFILE_ZONE_END(swapZone);
+
+        PROFILE_ZONE_END(frameZone);
+
+        PROFILE_ZONE_BEGIN(pacingZone, "frame pacing");
+        WaitForNextFrame(&framePacer); // Hold the frame to maxFPS (SUPPORT_CUSTOM_FRAME_CONTROL)
+        PROFILE_ZONE_END(pacingZone);
     }
 
     // Cleanup
     //-------------------------------------------------------------------------------------
 
-    UnloadTexture(textures[0]);
-    UnloadTexture(textures[1]);
+    if (physics != NULL)
+    {
+        StopPhysicsThread(physics);
+    }
+
+    FreeInterpolatedPoses(&poses);
+    DestroySpriteBatch(&spriteBatch);
+    UnloadGameAssets(&assets);
+    DestroyWorldStream(worldStream);
+    DestroyEntityStore(&entities);
+    b2DestroyWorld(worldId);
+    JobSystemDestroy(jobSystem);
 
     CloseWindow();
 
-    return 0;
+    return exitCode;
 }
@@ -0,0 +1,254 @@
+#include "physics_thread.h"
+#include "profiler.h"
+#include "thread.h"
+#include "timer.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Falling further behind than this drops the missed steps instead of catching up
+#define MAX_STEP_LAG 0.25
+
+struct PhysicsThread
+{
+    PhysicsThreadDef def;
+    SnapshotBuffer snapshots;
+    Thread *thread;
+    uint64_t stepIndex;
+    atomic_bool quit;
+    atomic_bool paused;
+
+    // Written by the render thread
+    Mutex *viewMutex;
+    b2AABB view;
+    bool hasView;
+
+    // Culling scratch, sized to the entity count
+    int *visibleIndices;
+    uint8_t *visibleMarks;
+    int visibleCapacity;
+};
+
+static bool GetView(PhysicsThread *physics, b2AABB *view)
+{
+    MutexLock(physics->viewMutex);
+    bool hasView = physics->hasView;
+    *view = physics->view;
+    MutexUnlock(physics->viewMutex);
+    return hasView;
+}
+
+// Returns the number of entities overlapping the view, their dense indices are in visibleIndices
+static int CullEntities(PhysicsThread *physics, b2AABB view)
+{
+    const EntityStore *entities = physics->def.entities;
+    if (entities->count > physics->visibleCapacity)
+    {
+        free(physics->visibleIndices);
+        free(physics->visibleMarks);
+        physics->visibleCapacity = entities->capacity;
+        physics->visibleIndices = malloc(sizeof(int) * (size_t)physics->visibleCapacity);
+        physics->visibleMarks = calloc((size_t)physics->visibleCapacity, sizeof(uint8_t));
+    }
+
+    return QueryEntitiesInAABB(
+        entities, physics->def.worldId, view, physics->visibleIndices, physics->visibleMarks);
+}
+
+// Copies entity index into entry i of the snapshot
+static void WritePose(PoseSnapshot *snapshot, int i, const EntityStore *entities, int index)
+{
+    float x = entities->positionX[index];
+    float y = entities->positionY[index];
+    float c = entities->rotationC[index];
+    float s = entities->rotationS[index];
+    snapshot->currentX[i] = x;
+    snapshot->currentY[i] = y;
+    snapshot->currentC[i] = c;
+    snapshot->currentS[i] = s;
+    snapshot->spriteIds[i] = entities->spriteIds[index];
+
+    // Entities the last step did not move are still where they were before it
+    bool moved = entities->moveSteps[index] == entities->moveStep;
+    snapshot->previousX[i] = moved ? entities->previousX[index] : x;
+    snapshot->previousY[i] = moved ? entities->previousY[index] : y;
+    snapshot->previousC[i] = moved ? entities->previousC[index] : c;
+    snapshot->previousS[i] = moved ? entities->previousS[index] : s;
+}
+
+// Copies the poses before and after the last step into the snapshot and hands it to the reader.
+// With a visible count the snapshot only holds the entities in visibleIndices.
+static void PublishCurrentPoses(PhysicsThread *physics, PoseSnapshot *snapshot, int visibleCount)
+{
+    const EntityStore *entities = physics->def.entities;
+
+    if (visibleCount < 0)
+    {
+        ReserveSnapshot(snapshot, entities->count);
+        for (int i = 0; i < entities->count; ++i)
+        {
+            WritePose(snapshot, i, entities, i);
+        }
+
+        snapshot->count = entities->count;
+    }
+    else
+    {
+        ReserveSnapshot(snapshot, visibleCount);
+        const int *indices = physics->visibleIndices;
+        for (int i = 0; i < visibleCount; ++i)
+        {
+            WritePose(snapshot, i, entities, indices[i]);
+        }
+
+        snapshot->count = visibleCount;
+    }
+
+    snapshot->entityCount = entities->count;
+    snapshot->stepIndex = physics->stepIndex;
+    snapshot->publishTime = TimerNow();
+    PublishSnapshot(&physics->snapshots);
+}
+
+static void StepAndPublish(PhysicsThread *physics, bool advance)
+{
+    const PhysicsThreadDef *def = &physics->def;
+    b2AABB view;
+    bool hasView = GetView(physics, &view);
+
+    // Bodies are created and destroyed before the step, so the poses before and after it describe
+    // the same entities
+    WorldStreamStats streamStats = {0};
+    if (def->stream != NULL && hasView)
+    {
+        PROFILE_ZONE_BEGIN(streamZone, "world stream");
+        b2Vec2 center = {0.5f * (view.lowerBound.x + view.upperBound.x),
+                         0.5f * (view.lowerBound.y + view.upperBound.y)};
+        UpdateWorldStream(def->stream, center);
+        streamStats = GetWorldStreamStats(def->stream);
+        PROFILE_ZONE_END(streamZone);
+    }
+
+    if (advance)
+    {
+        PROFILE_ZONE_BEGIN(stepZone, "b2World_Step");
+        b2World_Step(def->worldId, (float)def->fixedTimeStep, def->subStepCount);
+        PROFILE_ZONE_END(stepZone);
+        PROFILE_BOX2D_STEP(stepZone, def->worldId);
+
+        PROFILE_ZONE_BEGIN(transformZone, "entity transform");
+        ApplyBodyMoveEvents(def->entities, b2World_GetBodyEvents(def->worldId));
+        PROFILE_ZONE_END(transformZone);
+        physics->stepIndex += 1;
+    }
+    else
+    {
+        ClearEntityMoves(def->entities);
+    }
+
+    PROFILE_ZONE_BEGIN(publishZone, "publish snapshot");
+    PoseSnapshot *snapshot = GetWriteSnapshot(&physics->snapshots);
+    int visibleCount = hasView ? CullEntities(physics, view) : -1;
+    snapshot->stream = streamStats;
+    PublishCurrentPoses(physics, snapshot, visibleCount);
+    PROFILE_ZONE_END(publishZone);
+}
+
+static void PhysicsThreadMain(void *context)
+{
+    PhysicsThread *physics = context;
+    PROFILE_THREAD_NAME("physics");
+
+    if (physics->def.jobSystem != NULL)
+    {
+        JobSystemSetOwner(physics->def.jobSystem);
+    }
+
+    uint64_t stepNanoseconds = (uint64_t)(physics->def.fixedTimeStep * 1e9);
+    uint64_t nextStep = TimerNow() + stepNanoseconds;
+
+    while (!atomic_load(&physics->quit))
+    {
+        uint64_t now = TimerNow();
+        if (now < nextStep)
+        {
+            TimerSleep(nextStep - now);
+            continue;
+        }
+
+        if (TimerSeconds(nextStep, now) > MAX_STEP_LAG)
+        {
+            // Restart the schedule rather than burst through the backlog
+            nextStep = now;
+        }
+
+        StepAndPublish(physics, !atomic_load(&physics->paused));
+        nextStep += stepNanoseconds;
+    }
+
+    PROFILE_RELEASE_THREAD();
+}
+
+static void FreePhysicsThread(PhysicsThread *physics)
+{
+    FreeSnapshotBuffer(&physics->snapshots);
+    MutexDestroy(physics->viewMutex);
+    free(physics->visibleIndices);
+    free(physics->visibleMarks);
+    free(physics);
+}
+
+PhysicsThread *StartPhysicsThread(const PhysicsThreadDef *def)
+{
+    PhysicsThread *physics = calloc(1, sizeof(PhysicsThread));
+    physics->def = *def;
+    InitSnapshotBuffer(&physics->snapshots);
+    atomic_init(&physics->quit, false);
+    atomic_init(&physics->paused, false);
+    physics->viewMutex = MutexCreate();
+
+    // Initial poses, with nothing to interpolate from
+    ClearEntityMoves(physics->def.entities);
+    PoseSnapshot *snapshot = GetWriteSnapshot(&physics->snapshots);
+    PublishCurrentPoses(physics, snapshot, -1);
+
+    physics->thread = ThreadCreate(PhysicsThreadMain, physics);
+    if (physics->thread == NULL)
+    {
+        // Nobody holds the handle yet, so the published snapshot goes with the rest
+        FreePhysicsThread(physics);
+        return NULL;
+    }
+
+    return physics;
+}
+
+void StopPhysicsThread(PhysicsThread *physics)
+{
+    atomic_store(&physics->quit, true);
+    ThreadJoin(physics->thread);
+    FreePhysicsThread(physics);
+}
+
+void SetPhysicsPaused(PhysicsThread *physics, bool paused)
+{
+    atomic_store(&physics->paused, paused);
+}
+
+void SetPhysicsView(PhysicsThread *physics, b2AABB view)
+{
+    MutexLock(physics->viewMutex);
+    physics->view = view;
+    physics->hasView = true;
+    MutexUnlock(physics->viewMutex);
+}
+
+const PoseSnapshot *AcquirePhysicsSnapshot(PhysicsThread *physics)
+{
+    return AcquireSnapshot(&physics->snapshots);
+}
+
+double GetPhysicsFixedTimeStep(const PhysicsThread *physics)
+{
+    return physics->def.fixedTimeStep;
+}
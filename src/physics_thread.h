@@ -0,0 +1,47 @@
+#ifndef PHYSICS_THREAD_H
+#define PHYSICS_THREAD_H
+
+#include "box2d/box2d.h"
+#include "entities.h"
+#include "jobs.h"
+#include "snapshot.h"
+#include "worldstream.h"
+
+#include <stdbool.h>
+
+// Steps a world at a fixed rate on its own thread and publishes entity poses through a
+// SnapshotBuffer. While the thread runs it owns the world and the entity store; other threads may
+// only read snapshots.
+typedef struct PhysicsThreadDef
+{
+    b2WorldId worldId;
+    EntityStore *entities;
+    JobSystem *jobSystem; // optional, the physics thread becomes its owner so it helps with tasks
+    WorldStream *stream;  // optional, streamed around the center of the view before every step
+    double fixedTimeStep;
+    int subStepCount;
+} PhysicsThreadDef;
+
+typedef struct PhysicsThread PhysicsThread;
+
+// Publishes the initial poses, then starts stepping. Returns NULL when the thread cannot be
+// created, in which case the world and entities stay with the caller.
+PhysicsThread *StartPhysicsThread(const PhysicsThreadDef *def);
+
+// Stops stepping and joins the thread. The world and entities belong to the caller again.
+void StopPhysicsThread(PhysicsThread *physics);
+
+// While paused the world stops advancing, but streaming and culling keep following the view
+void SetPhysicsPaused(PhysicsThread *physics, bool paused);
+
+// Snapshots only carry entities whose shapes overlap view, found with b2World_OverlapAABB. Pad the
+// view by how far the camera and bodies can move within a step. Until the first call every entity
+// is published.
+void SetPhysicsView(PhysicsThread *physics, b2AABB view);
+
+// Reader side of the snapshot buffer, for a single render thread
+const PoseSnapshot *AcquirePhysicsSnapshot(PhysicsThread *physics);
+
+double GetPhysicsFixedTimeStep(const PhysicsThread *physics);
+
+#endif // PHYSICS_THREAD_H
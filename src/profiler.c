@@ -0,0 +1,416 @@
+#include "profiler.h"
+
+#if defined(ENABLE_PROFILER)
+
+#include "thread.h"
+#include "timer.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Events kept per thread, about a second of a busy frame loop at high frame rates
+#define PROFILER_RING_CAPACITY (1 << 15)
+#define PROFILER_MAX_THREADS 64
+
+// Most events copied out of a ring per lock, bounding how long its thread can be held up
+#define PROFILER_COPY_CHUNK 256
+
+typedef enum ProfileEventKind
+{
+    PROFILE_EVENT_ZONE,
+    PROFILE_EVENT_COUNTER,
+} ProfileEventKind;
+
+typedef struct ProfileEvent
+{
+    const char *name;
+    uint64_t start;
+    uint64_t end;
+    int64_t value;
+    ProfileEventKind kind;
+} ProfileEvent;
+
+// Written by its thread only. The lock is uncontended except while the main thread copies a chunk
+// of the ring for an export or a summary.
+typedef struct ProfileRing
+{
+    atomic_flag lock;
+    atomic_bool inUse;
+    uint64_t head;
+    int threadIndex;
+    char threadName[32];
+    ProfileEvent events[PROFILER_RING_CAPACITY];
+} ProfileRing;
+
+static _Atomic(ProfileRing *) rings[PROFILER_MAX_THREADS];
+static atomic_int ringCount;
+static _Thread_local ProfileRing *threadRing;
+
+// Trace timestamps are relative to the first event
+static _Atomic uint64_t epoch;
+
+// Scratch space of exports and summaries, kept so refreshing the overlay does not allocate
+static ProfileEvent *copiedEvents;
+static ProfileEvent *recentEvents;
+static int recentCapacity;
+static double *durations;
+static int durationCapacity;
+
+static void LockRing(ProfileRing *ring)
+{
+    while (atomic_flag_test_and_set_explicit(&ring->lock, memory_order_acquire))
+    {
+        ThreadPause();
+    }
+}
+
+static void UnlockRing(ProfileRing *ring)
+{
+    atomic_flag_clear_explicit(&ring->lock, memory_order_release);
+}
+
+static ProfileRing *GetThreadRing(void)
+{
+    if (threadRing != NULL)
+    {
+        return threadRing;
+    }
+
+    // Adopt the ring of a thread that has exited. Its events stay in the trace under the new name.
+    int existingCount = atomic_load(&ringCount);
+    for (int i = 0; i < existingCount && i < PROFILER_MAX_THREADS; ++i)
+    {
+        ProfileRing *ring = atomic_load_explicit(&rings[i], memory_order_acquire);
+        bool expected = false;
+        if (ring != NULL && atomic_compare_exchange_strong(&ring->inUse, &expected, true))
+        {
+            threadRing = ring;
+            return ring;
+        }
+    }
+
+    int index = atomic_fetch_add(&ringCount, 1);
+    if (index >= PROFILER_MAX_THREADS)
+    {
+        // Out of slots, the thread goes unprofiled
+        atomic_fetch_sub(&ringCount, 1);
+        return NULL;
+    }
+
+    uint64_t expected = 0;
+    atomic_compare_exchange_strong(&epoch, &expected, TimerNow());
+
+    ProfileRing *ring = calloc(1, sizeof(ProfileRing));
+    atomic_flag_clear(&ring->lock);
+    atomic_init(&ring->inUse, true);
+    ring->threadIndex = index;
+    snprintf(ring->threadName, sizeof(ring->threadName), "thread %d", index);
+
+    // Publish only once initialized; readers walk [0, ringCount) and skip empty slots
+    atomic_store_explicit(&rings[index], ring, memory_order_release);
+    threadRing = ring;
+    return ring;
+}
+
+static ProfileRing *LoadRing(int index)
+{
+    return atomic_load_explicit(&rings[index], memory_order_acquire);
+}
+
+static void PushEvent(ProfileEvent event)
+{
+    ProfileRing *ring = GetThreadRing();
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    LockRing(ring);
+    ring->events[ring->head % PROFILER_RING_CAPACITY] = event;
+    ring->head += 1;
+    UnlockRing(ring);
+}
+
+ProfileZone ProfilerBeginZone(const char *name)
+{
+    ProfileZone zone = {name, TimerNow()};
+    return zone;
+}
+
+void ProfilerEndZone(const ProfileZone *zone)
+{
+    ProfileEvent event = {zone->name, zone->start, TimerNow(), 0, PROFILE_EVENT_ZONE};
+    PushEvent(event);
+}
+
+void ProfilerCounter(const char *name, int64_t value)
+{
+    uint64_t now = TimerNow();
+    ProfileEvent event = {name, now, now, value, PROFILE_EVENT_COUNTER};
+    PushEvent(event);
+}
+
+void ProfilerSetThreadName(const char *name)
+{
+    ProfileRing *ring = GetThreadRing();
+    if (ring != NULL)
+    {
+        LockRing(ring);
+        snprintf(ring->threadName, sizeof(ring->threadName), "%s", name);
+        UnlockRing(ring);
+    }
+}
+
+void ProfilerReleaseThread(void)
+{
+    if (threadRing != NULL)
+    {
+        atomic_store(&threadRing->inUse, false);
+        threadRing = NULL;
+    }
+}
+
+static uint64_t AddPhase(const char *name, uint64_t start, float milliseconds)
+{
+    uint64_t end = start + (uint64_t)(milliseconds * 1e6f);
+    ProfileEvent event = {name, start, end, 0, PROFILE_EVENT_ZONE};
+    PushEvent(event);
+    return end;
+}
+
+void ProfilerRecordBox2DStep(uint64_t stepStart, b2Profile profile, b2Counters counters)
+{
+    uint64_t time = stepStart;
+    time = AddPhase("b2 pairs", time, profile.pairs);
+    time = AddPhase("b2 collide", time, profile.collide);
+    uint64_t solveEnd = AddPhase("b2 solve", time, profile.solve);
+
+    // Broadphase update and continuous collision run at the end of the solve
+    uint64_t continuousStart = solveEnd - (uint64_t)(profile.continuous * 1e6f);
+    uint64_t broadphaseStart = continuousStart - (uint64_t)(profile.broadphase * 1e6f);
+    AddPhase("b2 broadphase", broadphaseStart, profile.broadphase);
+    AddPhase("b2 continuous", continuousStart, profile.continuous);
+
+    ProfilerCounter("b2 bodies", counters.bodyCount);
+    ProfilerCounter("b2 contacts", counters.contactCount);
+    ProfilerCounter("b2 islands", counters.islandCount);
+    ProfilerCounter("b2 tasks", counters.taskCount);
+}
+
+static uint64_t GetOldestEvent(uint64_t head)
+{
+    return head > PROFILER_RING_CAPACITY ? head - PROFILER_RING_CAPACITY : 0;
+}
+
+// Copies the events buffered in a ring when the call starts to copiedEvents, oldest first, and
+// returns the number copied. The lock is only held for a chunk at a time, so the owning thread
+// keeps recording during the copy. Events it overwrites before their chunk is reached are skipped.
+static int CopyRing(ProfileRing *ring)
+{
+    if (copiedEvents == NULL)
+    {
+        copiedEvents = malloc(sizeof(ProfileEvent) * PROFILER_RING_CAPACITY);
+    }
+
+    LockRing(ring);
+    uint64_t end = ring->head;
+    UnlockRing(ring);
+
+    uint64_t cursor = GetOldestEvent(end);
+    int count = 0;
+    while (cursor < end)
+    {
+        LockRing(ring);
+        uint64_t oldest = GetOldestEvent(ring->head);
+        cursor = cursor < oldest ? oldest : cursor;
+        uint64_t chunkEnd = end - cursor > PROFILER_COPY_CHUNK ? cursor + PROFILER_COPY_CHUNK : end;
+        for (; cursor < chunkEnd; ++cursor)
+        {
+            copiedEvents[count++] = ring->events[cursor % PROFILER_RING_CAPACITY];
+        }
+        UnlockRing(ring);
+    }
+
+    return count;
+}
+
+// JSON string escaping for the characters that can plausibly show up in zone names
+static void WriteJsonString(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (const char *c = text; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', file);
+        }
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool ProfilerExportChromeTrace(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    uint64_t origin = atomic_load(&epoch);
+    bool first = true;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    int threadCount = atomic_load(&ringCount);
+    for (int t = 0; t < threadCount; ++t)
+    {
+        ProfileRing *ring = LoadRing(t);
+        if (ring == NULL)
+        {
+            continue;
+        }
+
+        char threadName[sizeof(ring->threadName)];
+        LockRing(ring);
+        memcpy(threadName, ring->threadName, sizeof(threadName));
+        UnlockRing(ring);
+
+        fprintf(file,
+                "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":",
+                first ? "" : ",\n",
+                ring->threadIndex);
+        WriteJsonString(file, threadName);
+        fprintf(file, "}}");
+        first = false;
+
+        int count = CopyRing(ring);
+        for (int i = 0; i < count; ++i)
+        {
+            const ProfileEvent *event = copiedEvents + i;
+            double ts = event->start > origin ? (double)(event->start - origin) * 1e-3 : 0.0;
+
+            fprintf(file, ",\n{\"name\":");
+            WriteJsonString(file, event->name);
+            if (event->kind == PROFILE_EVENT_ZONE)
+            {
+                fprintf(file,
+                        ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        ring->threadIndex,
+                        ts,
+                        (double)(event->end - event->start) * 1e-3);
+            }
+            else
+            {
+                fprintf(file,
+                        ",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"value\":%lld}}",
+                        ring->threadIndex,
+                        ts,
+                        (long long)event->value);
+            }
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+static int CompareDoubles(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static int CompareSummaries(const void *a, const void *b)
+{
+    double pa = ((const ProfileSummary *)a)->p99Ms;
+    double pb = ((const ProfileSummary *)b)->p99Ms;
+    return (pa < pb) - (pa > pb);
+}
+
+static double Percentile(const double *sorted, int count, double percentile)
+{
+    int rank = (int)(percentile / 100.0 * count + 0.5);
+    rank = rank < 1 ? 1 : (rank > count ? count : rank);
+    return sorted[rank - 1];
+}
+
+int ProfilerSummarize(ProfileSummary *summaries, int capacity, double windowSeconds)
+{
+    uint64_t now = TimerNow();
+    uint64_t windowStart = now - (uint64_t)(windowSeconds * 1e9);
+
+    // Gather recent zones from every thread
+    int threadCount = atomic_load(&ringCount);
+    int recentCount = 0;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        ProfileRing *ring = LoadRing(t);
+        int count = ring != NULL ? CopyRing(ring) : 0;
+        if (recentCount + count > recentCapacity)
+        {
+            recentCapacity = recentCount + count;
+            recentEvents = realloc(recentEvents, sizeof(ProfileEvent) * (size_t)recentCapacity);
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            const ProfileEvent *event = copiedEvents + i;
+            if (event->kind == PROFILE_EVENT_ZONE && event->end >= windowStart)
+            {
+                recentEvents[recentCount++] = *event;
+            }
+        }
+    }
+
+    if (recentCount > durationCapacity)
+    {
+        durationCapacity = recentCount;
+        durations = realloc(durations, sizeof(double) * (size_t)durationCapacity);
+    }
+
+    // Group by name pointer. The number of distinct zones is small, so a linear scan is fine.
+    ProfileEvent *recent = recentEvents;
+    int summaryCount = 0;
+    for (int i = 0; i < recentCount && summaryCount < capacity; ++i)
+    {
+        const char *name = recent[i].name;
+        if (name == NULL)
+        {
+            continue;
+        }
+
+        int count = 0;
+        double total = 0.0;
+        for (int j = i; j < recentCount; ++j)
+        {
+            if (recent[j].name == name)
+            {
+                double ms = (double)(recent[j].end - recent[j].start) * 1e-6;
+                durations[count++] = ms;
+                total += ms;
+
+                // Mark as consumed
+                recent[j].name = NULL;
+            }
+        }
+
+        qsort(durations, (size_t)count, sizeof(double), CompareDoubles);
+
+        ProfileSummary *summary = summaries + summaryCount++;
+        summary->name = name;
+        summary->count = count;
+        summary->meanMs = total / count;
+        summary->p50Ms = Percentile(durations, count, 50.0);
+        summary->p95Ms = Percentile(durations, count, 95.0);
+        summary->p99Ms = Percentile(durations, count, 99.0);
+    }
+
+    qsort(summaries, (size_t)summaryCount, sizeof(ProfileSummary), CompareSummaries);
+    return summaryCount;
+}
+
+#endif // ENABLE_PROFILER
@@ -0,0 +1,90 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Scoped CPU profiler for the frame loop. Every thread records into its own ring buffer, so only
+// the most recent events are kept. Build without ENABLE_PROFILER and the macros compile to
+// nothing.
+//
+//    PROFILE_ZONE_BEGIN(drawZone, "draw");
+//    ...
+//    PROFILE_ZONE_END(drawZone);
+//
+// Zone names must be string literals or otherwise outlive the profiler; summaries group by pointer.
+
+#if defined(ENABLE_PROFILER)
+
+#include "box2d/box2d.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROFILER_MAX_SUMMARIES 32
+
+typedef struct ProfileZone
+{
+    const char *name;
+    uint64_t start;
+} ProfileZone;
+
+// Rolling statistics of one zone name
+typedef struct ProfileSummary
+{
+    const char *name;
+    int count;
+    double meanMs;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+} ProfileSummary;
+
+ProfileZone ProfilerBeginZone(const char *name);
+void ProfilerEndZone(const ProfileZone *zone);
+
+// Records a value that Chrome draws as a counter track
+void ProfilerCounter(const char *name, int64_t value);
+
+// Names the calling thread in exported traces
+void ProfilerSetThreadName(const char *name);
+
+// Lets a later thread reuse the calling thread's ring. Call before a short-lived thread exits.
+void ProfilerReleaseThread(void);
+
+// Adds the phases Box2D measured during the step that started at stepStart. Box2D only reports
+// durations, so the phases are laid out back to back from the start of the step.
+void ProfilerRecordBox2DStep(uint64_t stepStart, b2Profile profile, b2Counters counters);
+
+// Exports and summaries copy the rings into scratch buffers the profiler keeps, so only one thread
+// may call them at a time.
+
+// Writes every buffered event as Chrome trace JSON, for chrome://tracing or ui.perfetto.dev
+bool ProfilerExportChromeTrace(const char *path);
+
+// Fills summaries for zones that ended within the last windowSeconds, slowest p99 first. Returns
+// the number of summaries written.
+int ProfilerSummarize(ProfileSummary *summaries, int capacity, double windowSeconds);
+
+#define PROFILE_ZONE_BEGIN(zone, name) ProfileZone zone = ProfilerBeginZone(name)
+#define PROFILE_ZONE_END(zone) ProfilerEndZone(&(zone))
+#define PROFILE_COUNTER(name, value) ProfilerCounter(name, value)
+#define PROFILE_THREAD_NAME(name) ProfilerSetThreadName(name)
+#define PROFILE_RELEASE_THREAD() ProfilerReleaseThread()
+#define PROFILE_EXPORT_TRACE(path) ProfilerExportChromeTrace(path)
+
+// Pass the zone that wraps b2World_Step
+#define PROFILE_BOX2D_STEP(stepZone, worldId)                                                     \
+    ProfilerRecordBox2DStep(                                                                      \
+        (stepZone).start, b2World_GetProfile(worldId), b2World_GetCounters(worldId))
+
+#else
+
+#define PROFILE_ZONE_BEGIN(zone, name)
+#define PROFILE_ZONE_END(zone)
+#define PROFILE_COUNTER(name, value)
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_RELEASE_THREAD()
+#define PROFILE_EXPORT_TRACE(path)
+#define PROFILE_BOX2D_STEP(stepZone, worldId)
+
+#endif // ENABLE_PROFILER
+
+#endif // PROFILER_H
@@ -0,0 +1,93 @@
+#include "profiler_overlay.h"
+#include "profiler.h"
+#include "raylib.h"
+
+#define OVERLAY_FONT_SIZE 20
+#define OVERLAY_LINE_HEIGHT 22
+#define OVERLAY_WIDTH 520
+
+// The default font is proportional, so columns are placed explicitly
+#define OVERLAY_COLUMN_WIDTH 90
+#define OVERLAY_NAME_WIDTH 220
+
+#if defined(ENABLE_PROFILER)
+
+// Summaries are rebuilt a few times per second. Doing it every frame would cost more than most of
+// the zones being measured.
+#define OVERLAY_REFRESH_SECONDS 0.25
+#define OVERLAY_WINDOW_SECONDS 1.0
+#define OVERLAY_MAX_ROWS 12
+
+static ProfileSummary overlaySummaries[PROFILER_MAX_SUMMARIES];
+static int overlaySummaryCount = 0;
+static double overlayRefreshTime = -1.0;
+
+static int ColumnX(int x, int column)
+{
+    return column == 0 ? x : x + OVERLAY_NAME_WIDTH + (column - 1) * OVERLAY_COLUMN_WIDTH;
+}
+
+void DrawProfilerOverlay(int x, int y, double frameTime)
+{
+    double now = GetTime();
+    if (overlayRefreshTime < 0.0 || now - overlayRefreshTime >= OVERLAY_REFRESH_SECONDS)
+    {
+        overlaySummaryCount =
+            ProfilerSummarize(overlaySummaries, PROFILER_MAX_SUMMARIES, OVERLAY_WINDOW_SECONDS);
+        overlayRefreshTime = now;
+    }
+
+    int rowCount = overlaySummaryCount < OVERLAY_MAX_ROWS ? overlaySummaryCount : OVERLAY_MAX_ROWS;
+    int height = (rowCount + 3) * OVERLAY_LINE_HEIGHT;
+    DrawRectangle(x - 8, y - 4, OVERLAY_WIDTH, height, Fade(BLACK, 0.6f));
+
+    DrawText(TextFormat("FPS: %i  frame: %.2f ms", (int)(1.0 / frameTime), frameTime * 1000.0),
+             x,
+             y,
+             OVERLAY_FONT_SIZE,
+             GREEN);
+    y += OVERLAY_LINE_HEIGHT;
+    const char *headers[4] = {"zone (ms)", "p50", "p95", "p99"};
+    for (int column = 0; column < 4; ++column)
+    {
+        DrawText(headers[column], ColumnX(x, column), y, OVERLAY_FONT_SIZE, LIGHTGRAY);
+    }
+    y += OVERLAY_LINE_HEIGHT;
+
+    for (int i = 0; i < rowCount; ++i)
+    {
+        const ProfileSummary *summary = overlaySummaries + i;
+        double values[3] = {summary->p50Ms, summary->p95Ms, summary->p99Ms};
+        DrawText(summary->name, x, y, OVERLAY_FONT_SIZE, WHITE);
+        for (int column = 1; column < 4; ++column)
+        {
+            DrawText(TextFormat("%.3f", values[column - 1]),
+                     ColumnX(x, column),
+                     y,
+                     OVERLAY_FONT_SIZE,
+                     WHITE);
+        }
+        y += OVERLAY_LINE_HEIGHT;
+    }
+
+    DrawText("F1 hide  F2 export trace.json", x, y, OVERLAY_FONT_SIZE, LIGHTGRAY);
+}
+
+#else
+
+void DrawProfilerOverlay(int x, int y, double frameTime)
+{
+    DrawRectangle(x - 8, y - 4, OVERLAY_WIDTH, 2 * OVERLAY_LINE_HEIGHT, Fade(BLACK, 0.6f));
+    DrawText(TextFormat("FPS: %i  frame: %.2f ms", (int)(1.0 / frameTime), frameTime * 1000.0),
+             x,
+             y,
+             OVERLAY_FONT_SIZE,
+             GREEN);
+    DrawText("Profiler disabled (ENABLE_PROFILER)",
+             x,
+             y + OVERLAY_LINE_HEIGHT,
+             OVERLAY_FONT_SIZE,
+             LIGHTGRAY);
+}
+
+#endif // ENABLE_PROFILER
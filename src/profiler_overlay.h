@@ -0,0 +1,8 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+// Draws the frame rate and, when the profiler is compiled in, a table of the slowest zones over
+// the last second. Call between BeginDrawing and EndDrawing.
+void DrawProfilerOverlay(int x, int y, double frameTime);
+
+#endif // PROFILER_OVERLAY_H
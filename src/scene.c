@@ -0,0 +1,137 @@
+#include "scene.h"
+
+#include <stdlib.h>
+
+SceneDef DefaultSceneDef(void)
+{
+    SceneDef def = {0};
+    def.tileSize = 1.0f;
+    def.groundCount = 20;
+    def.boxCount = 4;
+    def.stackHeight = 4;
+    return def;
+}
+
+Scene CreateScene(const b2WorldDef *worldDef, const SceneDef *def)
+{
+    Scene scene = {0};
+    scene.worldId = b2CreateWorld(worldDef);
+
+    float tileSize = def->tileSize;
+    b2Polygon tilePolygon = b2MakeSquare(0.5f * tileSize);
+
+    scene.groundCount = def->groundCount;
+    scene.groundBodies = malloc(sizeof(b2BodyId) * (size_t)def->groundCount);
+    for (int i = 0; i < def->groundCount; ++i)
+    {
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.position = (b2Vec2){(1.0f * i - 0.5f * def->groundCount) * tileSize,
+                                    -4.5f - 0.5f * tileSize};
+
+        // I used this rotation to test the world to screen transformation
+        bodyDef.angle = 0.25f * b2_pi * i;
+
+        scene.groundBodies[i] = b2CreateBody(scene.worldId, &bodyDef);
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        b2CreatePolygonShape(scene.groundBodies[i], &shapeDef, &tilePolygon);
+    }
+
+    int stackHeight = def->stackHeight > 0 ? def->stackHeight : 1;
+    int stackCount = (def->boxCount + stackHeight - 1) / stackHeight;
+
+    scene.boxCount = def->boxCount;
+    scene.boxBodies = malloc(sizeof(b2BodyId) * (size_t)def->boxCount);
+    for (int i = 0; i < def->boxCount; ++i)
+    {
+        int stack = i / stackHeight;
+        int level = i % stackHeight;
+        float stackX = (stack - 0.5f * (stackCount - 1)) * SCENE_STACK_SPACING * tileSize;
+
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.position = (b2Vec2){stackX + 0.5f * tileSize * level, -4.0f + tileSize * level};
+        scene.boxBodies[i] = b2CreateBody(scene.worldId, &bodyDef);
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        shapeDef.restitution = 0.1f;
+        b2CreatePolygonShape(scene.boxBodies[i], &shapeDef, &tilePolygon);
+    }
+
+    return scene;
+}
+
+void DestroyScene(Scene *scene)
+{
+    b2DestroyWorld(scene->worldId);
+    free(scene->groundBodies);
+    free(scene->boxBodies);
+    *scene = (Scene){0};
+}
+
+int GenerateSceneChunk(int chunkX, int chunkY, ChunkBody *bodies, int capacity, void *context)
+{
+    const SceneChunkDef *def = context;
+    if (chunkY != 0)
+    {
+        return 0;
+    }
+
+    float tileSize = def->tileSize;
+    int count = 0;
+    for (int i = 0; i < def->tilesPerChunk && count < capacity; ++i)
+    {
+        int tile = chunkX * def->tilesPerChunk + i;
+        ChunkBody *body = bodies + count++;
+        body->position =
+            (b2Vec2){def->origin.x + ((float)tile + 0.5f) * tileSize, -4.5f - 0.5f * tileSize};
+        body->angle = 0.25f * b2_pi * tile;
+        body->dynamic = false;
+        body->spriteId = def->groundSprite;
+    }
+
+    // Stacks are spaced as in CreateScene, starting one spacing into the chunk
+    int stackHeight = def->stackHeight > 0 ? def->stackHeight : 1;
+    float chunkX0 = def->origin.x + (float)(chunkX * def->tilesPerChunk) * tileSize;
+    for (int i = 0; i < def->boxesPerChunk && count < capacity; ++i)
+    {
+        int stack = i / stackHeight;
+        int level = i % stackHeight;
+        float stackX = chunkX0 + (float)((stack + 1) * SCENE_STACK_SPACING) * tileSize;
+
+        ChunkBody *body = bodies + count++;
+        body->position = (b2Vec2){stackX + 0.5f * tileSize * level, -4.0f + tileSize * level};
+        body->angle = 0.0f;
+        body->dynamic = true;
+        body->spriteId = def->boxSprite;
+    }
+
+    return count;
+}
+
+FixedStep MakeFixedStep(float fixedFPS, int subStepCount)
+{
+    FixedStep fixedStep = {0};
+    fixedStep.fixedTimeStep = 1.0 / fixedFPS;
+    fixedStep.subStepCount = subStepCount;
+    return fixedStep;
+}
+
+void FixedStepAdvance(FixedStep *fixedStep, double frameTime)
+{
+    fixedStep->accumulator += frameTime;
+}
+
+bool FixedStepConsume(FixedStep *fixedStep)
+{
+    if (fixedStep->accumulator < fixedStep->fixedTimeStep)
+    {
+        return false;
+    }
+
+    fixedStep->accumulator -= fixedStep->fixedTimeStep;
+    return true;
+}
+
+double FixedStepAlpha(const FixedStep *fixedStep)
+{
+    return fixedStep->accumulator / fixedStep->fixedTimeStep;
+}
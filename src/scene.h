@@ -0,0 +1,70 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "box2d/box2d.h"
+#include "worldstream.h"
+
+// Horizontal distance between box stacks, in tiles
+#define SCENE_STACK_SPACING 3
+
+// Describes the ground/box demo scene. The defaults reproduce the original 20 ground tiles and
+// 4 box staircase; the counts can be raised to stress the physics step.
+typedef struct SceneDef
+{
+    float tileSize;
+    int groundCount; // ground tiles laid out along the x axis, centered on the origin
+    int boxCount;    // dynamic boxes, split into staircase stacks
+    int stackHeight; // boxes per stack before a new stack is started to the right
+} SceneDef;
+
+typedef struct Scene
+{
+    b2WorldId worldId;
+    b2BodyId *groundBodies;
+    int groundCount;
+    b2BodyId *boxBodies;
+    int boxCount;
+} Scene;
+
+// Streamed version of the scene: a row of chunks, each a strip of ground tiles at the height of the
+// original floor with staircase box stacks on it. Chunk (0, 0) starts at origin.
+typedef struct SceneChunkDef
+{
+    b2Vec2 origin;
+    float tileSize;
+    int tilesPerChunk;
+    int boxesPerChunk;
+    int stackHeight;
+    int groundSprite;
+    int boxSprite;
+} SceneChunkDef;
+
+// Fixed timestep accumulator shared by the game loop and the headless benchmark
+typedef struct FixedStep
+{
+    double fixedTimeStep;
+    double accumulator;
+    int subStepCount;
+} FixedStep;
+
+SceneDef DefaultSceneDef(void);
+
+// Creates a world from worldDef and populates it according to def
+Scene CreateScene(const b2WorldDef *worldDef, const SceneDef *def);
+void DestroyScene(Scene *scene);
+
+// ChunkGenerator for a SceneChunkDef passed as context. Only the chunk row at y = 0 has bodies.
+int GenerateSceneChunk(int chunkX, int chunkY, ChunkBody *bodies, int capacity, void *context);
+
+FixedStep MakeFixedStep(float fixedFPS, int subStepCount);
+
+// Adds frame time to the accumulator
+void FixedStepAdvance(FixedStep *fixedStep, double frameTime);
+
+// Returns true and consumes one fixed step if enough time has accumulated
+bool FixedStepConsume(FixedStep *fixedStep);
+
+// Left over time as a fraction of a fixed step, used for interpolation
+double FixedStepAlpha(const FixedStep *fixedStep);
+
+#endif // SCENE_H
@@ -0,0 +1,147 @@
+#include "snapshot.h"
+#include "timer.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_FRESH 4
+#define SNAPSHOT_INDEX_MASK 3
+
+static void FreeSnapshot(PoseSnapshot *snapshot)
+{
+    free(snapshot->previousX);
+    free(snapshot->previousY);
+    free(snapshot->previousC);
+    free(snapshot->previousS);
+    free(snapshot->currentX);
+    free(snapshot->currentY);
+    free(snapshot->currentC);
+    free(snapshot->currentS);
+    free(snapshot->spriteIds);
+    memset(snapshot, 0, sizeof(PoseSnapshot));
+}
+
+static float *GrowFloats(float *array, int capacity)
+{
+    return realloc(array, sizeof(float) * (size_t)capacity);
+}
+
+void ReserveSnapshot(PoseSnapshot *snapshot, int capacity)
+{
+    if (capacity <= snapshot->capacity)
+    {
+        return;
+    }
+
+    snapshot->previousX = GrowFloats(snapshot->previousX, capacity);
+    snapshot->previousY = GrowFloats(snapshot->previousY, capacity);
+    snapshot->previousC = GrowFloats(snapshot->previousC, capacity);
+    snapshot->previousS = GrowFloats(snapshot->previousS, capacity);
+    snapshot->currentX = GrowFloats(snapshot->currentX, capacity);
+    snapshot->currentY = GrowFloats(snapshot->currentY, capacity);
+    snapshot->currentC = GrowFloats(snapshot->currentC, capacity);
+    snapshot->currentS = GrowFloats(snapshot->currentS, capacity);
+    snapshot->spriteIds = realloc(snapshot->spriteIds, sizeof(int) * (size_t)capacity);
+    snapshot->capacity = capacity;
+}
+
+void InitSnapshotBuffer(SnapshotBuffer *buffer)
+{
+    memset(buffer->snapshots, 0, sizeof(buffer->snapshots));
+    buffer->back = 0;
+    atomic_init(&buffer->middle, 1);
+    buffer->front = 2;
+}
+
+void FreeSnapshotBuffer(SnapshotBuffer *buffer)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        FreeSnapshot(buffer->snapshots + i);
+    }
+}
+
+PoseSnapshot *GetWriteSnapshot(SnapshotBuffer *buffer)
+{
+    return buffer->snapshots + buffer->back;
+}
+
+void PublishSnapshot(SnapshotBuffer *buffer)
+{
+    // Release makes the snapshot contents visible to the reader that acquires this index
+    int previous = atomic_exchange_explicit(&buffer->middle,
+                                            buffer->back | SNAPSHOT_FRESH,
+                                            memory_order_acq_rel);
+    buffer->back = previous & SNAPSHOT_INDEX_MASK;
+}
+
+const PoseSnapshot *AcquireSnapshot(SnapshotBuffer *buffer)
+{
+    if (atomic_load_explicit(&buffer->middle, memory_order_relaxed) & SNAPSHOT_FRESH)
+    {
+        int previous =
+            atomic_exchange_explicit(&buffer->middle, buffer->front, memory_order_acq_rel);
+        buffer->front = previous & SNAPSHOT_INDEX_MASK;
+    }
+
+    return buffer->snapshots + buffer->front;
+}
+
+float GetSnapshotAlpha(const PoseSnapshot *snapshot, double fixedTimeStep, uint64_t now)
+{
+    if (now <= snapshot->publishTime)
+    {
+        return 0.0f;
+    }
+
+    double alpha = TimerSeconds(snapshot->publishTime, now) / fixedTimeStep;
+    return alpha < 1.0 ? (float)alpha : 1.0f;
+}
+
+void InterpolateSnapshot(const PoseSnapshot *snapshot, float alpha, InterpolatedPoses *poses)
+{
+    int count = snapshot->count;
+    if (count > poses->capacity)
+    {
+        poses->positionX = GrowFloats(poses->positionX, count);
+        poses->positionY = GrowFloats(poses->positionY, count);
+        poses->rotationC = GrowFloats(poses->rotationC, count);
+        poses->rotationS = GrowFloats(poses->rotationS, count);
+        poses->capacity = count;
+    }
+
+    float beta = 1.0f - alpha;
+    for (int i = 0; i < count; ++i)
+    {
+        poses->positionX[i] = beta * snapshot->previousX[i] + alpha * snapshot->currentX[i];
+        poses->positionY[i] = beta * snapshot->previousY[i] + alpha * snapshot->currentY[i];
+
+        // Normalized lerp, falling back to the current rotation for half turns within one step
+        float c = beta * snapshot->previousC[i] + alpha * snapshot->currentC[i];
+        float s = beta * snapshot->previousS[i] + alpha * snapshot->currentS[i];
+        float lengthSquared = c * c + s * s;
+        if (lengthSquared > 1e-6f)
+        {
+            float invLength = 1.0f / sqrtf(lengthSquared);
+            poses->rotationC[i] = c * invLength;
+            poses->rotationS[i] = s * invLength;
+        }
+        else
+        {
+            poses->rotationC[i] = snapshot->currentC[i];
+            poses->rotationS[i] = snapshot->currentS[i];
+        }
+    }
+
+    poses->count = count;
+}
+
+void FreeInterpolatedPoses(InterpolatedPoses *poses)
+{
+    free(poses->positionX);
+    free(poses->positionY);
+    free(poses->rotationC);
+    free(poses->rotationS);
+    memset(poses, 0, sizeof(InterpolatedPoses));
+}
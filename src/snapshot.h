@@ -0,0 +1,73 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "worldstream.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Entity poses published by one physics step. Each snapshot carries the poses from before and
+// after the step so the renderer can interpolate from a single buffer.
+typedef struct PoseSnapshot
+{
+    float *previousX;
+    float *previousY;
+    float *previousC;
+    float *previousS;
+    float *currentX;
+    float *currentY;
+    float *currentC;
+    float *currentS;
+    int *spriteIds;
+    int count; // poses in the snapshot, after culling to the view
+    int capacity;
+    int entityCount; // entities in the world when the snapshot was published
+
+    WorldStreamStats stream;
+    uint64_t stepIndex;
+    uint64_t publishTime; // TimerNow() when the snapshot was published
+} PoseSnapshot;
+
+// Lock-free triple buffer with a single writer and a single reader. The writer fills the back
+// buffer and swaps it with the middle one; the reader swaps the middle buffer into the front when a
+// newer one was published. Neither side ever waits for the other.
+typedef struct SnapshotBuffer
+{
+    PoseSnapshot snapshots[3];
+    atomic_int middle; // index of the shared snapshot, plus SNAPSHOT_FRESH when unread
+    int back;          // owned by the writer
+    int front;         // owned by the reader
+} SnapshotBuffer;
+
+// Interpolated poses ready for the sprite batch
+typedef struct InterpolatedPoses
+{
+    float *positionX;
+    float *positionY;
+    float *rotationC;
+    float *rotationS;
+    int count;
+    int capacity;
+} InterpolatedPoses;
+
+void InitSnapshotBuffer(SnapshotBuffer *buffer);
+void FreeSnapshotBuffer(SnapshotBuffer *buffer);
+
+// Writer side. The returned snapshot is private to the writer until PublishSnapshot.
+PoseSnapshot *GetWriteSnapshot(SnapshotBuffer *buffer);
+void PublishSnapshot(SnapshotBuffer *buffer);
+
+// Reader side. Returns the newest published snapshot, which stays valid until the next call.
+const PoseSnapshot *AcquireSnapshot(SnapshotBuffer *buffer);
+
+// Grows the pose arrays of a snapshot owned by the caller
+void ReserveSnapshot(PoseSnapshot *snapshot, int capacity);
+
+// Fraction of a fixed step elapsed since the snapshot was published, clamped to [0, 1]
+float GetSnapshotAlpha(const PoseSnapshot *snapshot, double fixedTimeStep, uint64_t now);
+
+// Blends previous and current poses. Rotations are normalized after blending.
+void InterpolateSnapshot(const PoseSnapshot *snapshot, float alpha, InterpolatedPoses *poses);
+void FreeInterpolatedPoses(InterpolatedPoses *poses);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,185 @@
+#include "spritebatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void Reserve(SpriteBatch *batch, int capacity)
+{
+    if (capacity <= batch->capacity)
+    {
+        return;
+    }
+
+    free(batch->vertices);
+    free(batch->groups);
+    free(batch->centerX);
+    free(batch->centerY);
+    free(batch->extentA);
+    free(batch->extentB);
+
+    batch->vertices = malloc(sizeof(SpriteVertex) * 4 * (size_t)capacity);
+    batch->groups = malloc(sizeof(SpriteGroup) * (size_t)capacity);
+    batch->centerX = malloc(sizeof(float) * (size_t)capacity);
+    batch->centerY = malloc(sizeof(float) * (size_t)capacity);
+    batch->extentA = malloc(sizeof(float) * (size_t)capacity);
+    batch->extentB = malloc(sizeof(float) * (size_t)capacity);
+    batch->capacity = capacity;
+}
+
+static void ReservePages(SpriteBatch *batch, int pageCount)
+{
+    if (pageCount <= batch->pageCapacity)
+    {
+        return;
+    }
+
+    free(batch->pageCursors);
+    batch->pageCursors = malloc(sizeof(int) * (size_t)pageCount);
+    batch->pageCapacity = pageCount;
+}
+
+SpriteBatch CreateSpriteBatch(int capacity)
+{
+    SpriteBatch batch = {0};
+    Reserve(&batch, capacity > 0 ? capacity : 64);
+    ReservePages(&batch, 8);
+    return batch;
+}
+
+void DestroySpriteBatch(SpriteBatch *batch)
+{
+    free(batch->vertices);
+    free(batch->groups);
+    free(batch->centerX);
+    free(batch->centerY);
+    free(batch->extentA);
+    free(batch->extentB);
+    free(batch->pageCursors);
+    *batch = (SpriteBatch){0};
+}
+
+// World to screen for every instance. Straight-line float math over separate arrays so the
+// compiler vectorizes it for whatever SIMD width the target has (SSE, AVX, NEON, wasm simd).
+static void TransformInstances(float *restrict centerX,
+                               float *restrict centerY,
+                               float *restrict extentA,
+                               float *restrict extentB,
+                               const float *restrict positionX,
+                               const float *restrict positionY,
+                               const float *restrict rotationC,
+                               const float *restrict rotationS,
+                               int count,
+                               Conversion cv)
+{
+    float scale = cv.scale;
+    float offsetX = 0.5f * cv.screenWidth - scale * cv.camera.x;
+    float offsetY = 0.5f * cv.screenHeight + scale * cv.camera.y;
+    float halfExtent = 0.5f * cv.tileSize * cv.scale;
+
+    for (int i = 0; i < count; ++i)
+    {
+        float a = halfExtent * rotationC[i];
+        float b = halfExtent * rotationS[i];
+        centerX[i] = scale * positionX[i] + offsetX;
+        centerY[i] = offsetY - scale * positionY[i];
+        extentA[i] = a + b;
+        extentB[i] = a - b;
+    }
+}
+
+// Page of the instance's frame, or -1 when its sprite id or the page is out of range
+static int GetInstancePage(const SpriteInstances *instances,
+                           int i,
+                           const SpriteFrame *frames,
+                           int frameCount,
+                           int pageCount)
+{
+    int spriteId = instances->spriteIds[i];
+    if (spriteId < 0 || spriteId >= frameCount)
+    {
+        return -1;
+    }
+
+    int page = frames[spriteId].page;
+    return 0 <= page && page < pageCount ? page : -1;
+}
+
+void BuildSpriteBatch(SpriteBatch *batch,
+                      const SpriteInstances *instances,
+                      const SpriteFrame *frames,
+                      int frameCount,
+                      int pageCount,
+                      Conversion cv)
+{
+    int count = instances->count;
+    Reserve(batch, count);
+    ReservePages(batch, pageCount);
+
+    TransformInstances(batch->centerX,
+                       batch->centerY,
+                       batch->extentA,
+                       batch->extentB,
+                       instances->positionX,
+                       instances->positionY,
+                       instances->rotationC,
+                       instances->rotationS,
+                       count,
+                       cv);
+
+    // Counting sort by page: count, then turn the counts into the first quad of each group
+    int *pageCursors = batch->pageCursors;
+    memset(pageCursors, 0, sizeof(int) * (size_t)pageCount);
+    int skippedCount = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        int page = GetInstancePage(instances, i, frames, frameCount, pageCount);
+        if (page < 0)
+        {
+            skippedCount += 1;
+            continue;
+        }
+
+        pageCursors[page] += 1;
+    }
+
+    batch->groupCount = 0;
+    int firstQuad = 0;
+    for (int page = 0; page < pageCount; ++page)
+    {
+        int quadCount = pageCursors[page];
+        if (quadCount > 0)
+        {
+            batch->groups[batch->groupCount++] = (SpriteGroup){page, firstQuad, quadCount};
+        }
+
+        pageCursors[page] = firstQuad;
+        firstQuad += quadCount;
+    }
+
+    // Scatter the quads into their group
+    for (int i = 0; i < count; ++i)
+    {
+        int page = GetInstancePage(instances, i, frames, frameCount, pageCount);
+        if (page < 0)
+        {
+            continue;
+        }
+
+        const SpriteFrame *frame = frames + instances->spriteIds[i];
+        SpriteVertex *v = batch->vertices + 4 * pageCursors[page]++;
+
+        float cx = batch->centerX[i];
+        float cy = batch->centerY[i];
+        float ea = batch->extentA[i];
+        float eb = batch->extentB[i];
+
+        // Screen y points down, so the corners are mirrored relative to world space
+        v[0] = (SpriteVertex){cx - ea, cy - eb, frame->u0, frame->v0};
+        v[1] = (SpriteVertex){cx - eb, cy + ea, frame->u0, frame->v1};
+        v[2] = (SpriteVertex){cx + ea, cy + eb, frame->u1, frame->v1};
+        v[3] = (SpriteVertex){cx + eb, cy - ea, frame->u1, frame->v0};
+    }
+
+    batch->quadCount = count - skippedCount;
+    batch->skippedCount = skippedCount;
+}
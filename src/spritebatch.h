@@ -0,0 +1,79 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include "conversion.h"
+
+// CPU side sprite batching. BuildSpriteBatch turns sprite poses into screen space quads grouped by
+// texture page without touching the GPU, DrawSpriteBatch then submits one draw per group.
+
+typedef struct SpriteVertex
+{
+    float x;
+    float y;
+    float u;
+    float v;
+} SpriteVertex;
+
+// Region of a texture page, in normalized texture coordinates
+typedef struct SpriteFrame
+{
+    int page;
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+} SpriteFrame;
+
+// Consecutive quads that share a texture page
+typedef struct SpriteGroup
+{
+    int page;
+    int firstQuad;
+    int quadCount;
+} SpriteGroup;
+
+// Sprite poses in world space, one tile in size, as struct-of-arrays
+typedef struct SpriteInstances
+{
+    const float *positionX;
+    const float *positionY;
+    const float *rotationC;
+    const float *rotationS;
+    const int *spriteIds;
+    int count;
+} SpriteInstances;
+
+typedef struct SpriteBatch
+{
+    SpriteVertex *vertices; // 4 per quad: top left, bottom left, bottom right, top right
+    int quadCount;
+    SpriteGroup *groups;
+    int groupCount;
+    int skippedCount; // instances left out for an invalid sprite id or page
+    int capacity;
+
+    // Scratch space for the transform pass
+    float *centerX;
+    float *centerY;
+    float *extentA;
+    float *extentB;
+    int *pageCursors;
+    int pageCapacity;
+} SpriteBatch;
+
+SpriteBatch CreateSpriteBatch(int capacity);
+void DestroySpriteBatch(SpriteBatch *batch);
+
+// Rebuilds the batch from the instances. Frames map sprite ids to pages. Instances whose sprite id
+// is not below frameCount, or whose frame's page is not below pageCount, are skipped and counted.
+void BuildSpriteBatch(SpriteBatch *batch,
+                      const SpriteInstances *instances,
+                      const SpriteFrame *frames,
+                      int frameCount,
+                      int pageCount,
+                      Conversion cv);
+
+// Submits each group with a single rlgl draw. pageTextureIds holds the OpenGL texture of each page.
+void DrawSpriteBatch(const SpriteBatch *batch, const unsigned int *pageTextureIds);
+
+#endif // SPRITEBATCH_H
@@ -0,0 +1,27 @@
+#include "rlgl.h"
+#include "spritebatch.h"
+
+void DrawSpriteBatch(const SpriteBatch *batch, const unsigned int *pageTextureIds)
+{
+    for (int i = 0; i < batch->groupCount; ++i)
+    {
+        const SpriteGroup *group = batch->groups + i;
+        const SpriteVertex *v = batch->vertices + 4 * group->firstQuad;
+        int vertexCount = 4 * group->quadCount;
+
+        rlSetTexture(pageTextureIds[group->page]);
+        rlBegin(RL_QUADS);
+        rlColor4ub(255, 255, 255, 255);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+
+        for (int j = 0; j < vertexCount; ++j)
+        {
+            rlTexCoord2f(v[j].u, v[j].v);
+            rlVertex2f(v[j].x, v[j].y);
+        }
+
+        rlEnd();
+    }
+
+    rlSetTexture(0);
+}
@@ -0,0 +1,213 @@
+#include "thread.h"
+
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+struct Thread
+{
+    ThreadFunc *func;
+    void *context;
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+};
+
+struct Mutex
+{
+#if defined(_WIN32)
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+};
+
+struct Condition
+{
+#if defined(_WIN32)
+    CONDITION_VARIABLE variable;
+#else
+    pthread_cond_t variable;
+#endif
+};
+
+#if defined(_WIN32)
+static DWORD WINAPI ThreadMain(LPVOID param)
+{
+    Thread *thread = param;
+    thread->func(thread->context);
+    return 0;
+}
+#else
+static void *ThreadMain(void *param)
+{
+    Thread *thread = param;
+    thread->func(thread->context);
+    return NULL;
+}
+#endif
+
+Thread *ThreadCreate(ThreadFunc *func, void *context)
+{
+    Thread *thread = malloc(sizeof(Thread));
+    thread->func = func;
+    thread->context = context;
+
+#if defined(_WIN32)
+    thread->handle = CreateThread(NULL, 0, ThreadMain, thread, 0, NULL);
+    if (thread->handle == NULL)
+    {
+        free(thread);
+        return NULL;
+    }
+#else
+    if (pthread_create(&thread->handle, NULL, ThreadMain, thread) != 0)
+    {
+        free(thread);
+        return NULL;
+    }
+#endif
+
+    return thread;
+}
+
+void ThreadJoin(Thread *thread)
+{
+#if defined(_WIN32)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+    free(thread);
+}
+
+void ThreadYield(void)
+{
+#if defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+void ThreadPause(void)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    __yield();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+int GetCoreCount(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 0 ? count : 1;
+}
+
+Mutex *MutexCreate(void)
+{
+    Mutex *mutex = malloc(sizeof(Mutex));
+#if defined(_WIN32)
+    InitializeSRWLock(&mutex->lock);
+#else
+    pthread_mutex_init(&mutex->lock, NULL);
+#endif
+    return mutex;
+}
+
+void MutexDestroy(Mutex *mutex)
+{
+#if !defined(_WIN32)
+    pthread_mutex_destroy(&mutex->lock);
+#endif
+    free(mutex);
+}
+
+void MutexLock(Mutex *mutex)
+{
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&mutex->lock);
+#else
+    pthread_mutex_lock(&mutex->lock);
+#endif
+}
+
+void MutexUnlock(Mutex *mutex)
+{
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&mutex->lock);
+#else
+    pthread_mutex_unlock(&mutex->lock);
+#endif
+}
+
+Condition *ConditionCreate(void)
+{
+    Condition *condition = malloc(sizeof(Condition));
+#if defined(_WIN32)
+    InitializeConditionVariable(&condition->variable);
+#else
+    pthread_cond_init(&condition->variable, NULL);
+#endif
+    return condition;
+}
+
+void ConditionDestroy(Condition *condition)
+{
+#if !defined(_WIN32)
+    pthread_cond_destroy(&condition->variable);
+#endif
+    free(condition);
+}
+
+void ConditionWait(Condition *condition, Mutex *mutex)
+{
+#if defined(_WIN32)
+    SleepConditionVariableSRW(&condition->variable, &mutex->lock, INFINITE, 0);
+#else
+    pthread_cond_wait(&condition->variable, &mutex->lock);
+#endif
+}
+
+void ConditionSignal(Condition *condition)
+{
+#if defined(_WIN32)
+    WakeConditionVariable(&condition->variable);
+#else
+    pthread_cond_signal(&condition->variable);
+#endif
+}
+
+void ConditionBroadcast(Condition *condition)
+{
+#if defined(_WIN32)
+    WakeAllConditionVariable(&condition->variable);
+#else
+    pthread_cond_broadcast(&condition->variable);
+#endif
+}
@@ -0,0 +1,40 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+// Minimal portable threading primitives. Handles are heap allocated so platform headers stay out
+// of the rest of the code base.
+
+typedef struct Thread Thread;
+typedef struct Mutex Mutex;
+typedef struct Condition Condition;
+
+typedef void ThreadFunc(void *context);
+
+Thread *ThreadCreate(ThreadFunc *func, void *context);
+
+// Waits for the thread to return and frees it
+void ThreadJoin(Thread *thread);
+
+// Gives up the rest of the time slice
+void ThreadYield(void);
+
+// Hint to the CPU that the caller is spinning
+void ThreadPause(void);
+
+// Number of logical processors, at least 1
+int GetCoreCount(void);
+
+Mutex *MutexCreate(void);
+void MutexDestroy(Mutex *mutex);
+void MutexLock(Mutex *mutex);
+void MutexUnlock(Mutex *mutex);
+
+Condition *ConditionCreate(void);
+void ConditionDestroy(Condition *condition);
+
+// Atomically releases the mutex and waits, reacquiring it before returning. May wake spuriously.
+void ConditionWait(Condition *condition, Mutex *mutex);
+void ConditionSignal(Condition *condition);
+void ConditionBroadcast(Condition *condition);
+
+#endif // THREAD_H
@@ -0,0 +1,393 @@
+#include "tilemap.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Outline edges run along tile sides between grid vertices. Each vertex keeps a bit per direction
+// for the edges of the current region starting there, and the same bits shifted up once traced.
+enum
+{
+    EDGE_RIGHT,
+    EDGE_UP,
+    EDGE_LEFT,
+    EDGE_DOWN,
+};
+
+#define EDGE_MASK 0xF
+#define EDGE_TRACED_SHIFT 4
+
+static const int edgeDeltaX[4] = {1, 0, -1, 0};
+static const int edgeDeltaY[4] = {0, 1, 0, -1};
+
+// A tile side facing an empty neighbor in a direction becomes an edge turned a quarter to the left
+// of it, so the tile is on the left of the edge. This is the start corner of that edge.
+static const int sideStartX[4] = {1, 1, 0, 0};
+static const int sideStartY[4] = {0, 1, 1, 0};
+
+typedef struct OutlineBuilder
+{
+    const TileLayer *layer;
+    int vertexStride; // vertices per grid row, width + 1
+    uint8_t *edges;   // per vertex
+    uint8_t *visited; // per tile
+
+    // Scratch sized to the largest region so far
+    int *cells;  // tiles of the region being traced
+    int *stack;  // flood fill
+    int *starts; // vertices with an edge of the region, up to four per tile
+    int *traceVertices;
+    uint8_t *traceDirections;
+    int scratchCapacity;
+
+    TileOutlines outlines;
+    int pointCapacity;
+    int loopCapacity;
+} OutlineBuilder;
+
+static void GrowArray(void **array, int capacity, size_t elementSize)
+{
+    void *grown = realloc(*array, (size_t)capacity * elementSize);
+    assert(grown != NULL);
+    *array = grown;
+}
+
+static void ReserveScratch(OutlineBuilder *builder, int tileCount)
+{
+    if (tileCount <= builder->scratchCapacity)
+    {
+        return;
+    }
+
+    int capacity = 2 * builder->scratchCapacity;
+    capacity = capacity > tileCount ? capacity : tileCount;
+    GrowArray((void **)&builder->cells, capacity, sizeof(int));
+    GrowArray((void **)&builder->stack, capacity, sizeof(int));
+    GrowArray((void **)&builder->starts, 4 * capacity, sizeof(int));
+    GrowArray((void **)&builder->traceVertices, 4 * capacity, sizeof(int));
+    GrowArray((void **)&builder->traceDirections, 4 * capacity, sizeof(uint8_t));
+    builder->scratchCapacity = capacity;
+}
+
+TileLayer CreateTileLayer(int width, int height, b2Vec2 origin, float tileSize)
+{
+    TileLayer layer = {0};
+    layer.width = width;
+    layer.height = height;
+    layer.origin = origin;
+    layer.tileSize = tileSize;
+    layer.tiles = malloc(sizeof(int) * (size_t)width * (size_t)height);
+    for (int i = 0; i < width * height; ++i)
+    {
+        layer.tiles[i] = TILE_EMPTY;
+    }
+
+    return layer;
+}
+
+void DestroyTileLayer(TileLayer *layer)
+{
+    free(layer->tiles);
+    *layer = (TileLayer){0};
+}
+
+bool IsTileSolid(const TileLayer *layer, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < layer->width && y < layer->height &&
+           layer->tiles[y * layer->width + x] != TILE_EMPTY;
+}
+
+// Collects the 4-connected region containing firstTile into cells and returns its size
+static int FloodRegion(OutlineBuilder *builder, int firstTile)
+{
+    const TileLayer *layer = builder->layer;
+    int count = 0;
+    int stackCount = 0;
+
+    // A tile is pushed at most once, so the stack never outgrows the region
+    ReserveScratch(builder, 1);
+    builder->stack[stackCount++] = firstTile;
+    builder->visited[firstTile] = 1;
+
+    while (stackCount > 0)
+    {
+        int tile = builder->stack[--stackCount];
+        builder->cells[count++] = tile;
+
+        int x = tile % layer->width;
+        int y = tile / layer->width;
+        for (int direction = 0; direction < 4; ++direction)
+        {
+            int nx = x + edgeDeltaX[direction];
+            int ny = y + edgeDeltaY[direction];
+            int neighbor = ny * layer->width + nx;
+            if (IsTileSolid(layer, nx, ny) && !builder->visited[neighbor])
+            {
+                builder->visited[neighbor] = 1;
+                ReserveScratch(builder, count + stackCount + 1);
+                builder->stack[stackCount++] = neighbor;
+            }
+        }
+    }
+
+    return count;
+}
+
+// Adds an edge for every side of the region facing an empty tile. Returns the number of starts.
+static int AddRegionEdges(OutlineBuilder *builder, int tileCount)
+{
+    const TileLayer *layer = builder->layer;
+    int startCount = 0;
+    for (int i = 0; i < tileCount; ++i)
+    {
+        int x = builder->cells[i] % layer->width;
+        int y = builder->cells[i] / layer->width;
+        for (int side = 0; side < 4; ++side)
+        {
+            if (IsTileSolid(layer, x + edgeDeltaX[side], y + edgeDeltaY[side]))
+            {
+                continue;
+            }
+
+            int vertex = (y + sideStartY[side]) * builder->vertexStride + x + sideStartX[side];
+            builder->edges[vertex] |= (uint8_t)(1u << ((side + 1) & 3));
+            builder->starts[startCount++] = vertex;
+        }
+    }
+
+    return startCount;
+}
+
+static void AddOutlinePoint(OutlineBuilder *builder, int vertex)
+{
+    TileOutlines *outlines = &builder->outlines;
+    if (outlines->pointCount == builder->pointCapacity)
+    {
+        builder->pointCapacity = builder->pointCapacity > 0 ? 2 * builder->pointCapacity : 256;
+        GrowArray((void **)&outlines->points, builder->pointCapacity, sizeof(b2Vec2));
+    }
+
+    float tileSize = builder->layer->tileSize;
+    outlines->points[outlines->pointCount++] =
+        (b2Vec2){(float)(vertex % builder->vertexStride) * tileSize,
+                 (float)(vertex / builder->vertexStride) * tileSize};
+}
+
+// Follows untraced edges from start until the walk closes, then adds the corners as a loop
+static void TraceLoop(OutlineBuilder *builder, int start, int firstDirection, int region)
+{
+    int count = 0;
+    int vertex = start;
+    int direction = firstDirection;
+    do
+    {
+        builder->edges[vertex] |= (uint8_t)(1u << (direction + EDGE_TRACED_SHIFT));
+        builder->traceVertices[count] = vertex;
+        builder->traceDirections[count] = (uint8_t)direction;
+        count += 1;
+
+        vertex += edgeDeltaY[direction] * builder->vertexStride + edgeDeltaX[direction];
+
+        // Only a corner where two tiles of the region touch diagonally has two ways on. Turning
+        // right there keeps the two empty tiles apart, so the enclosed one gets a loop of its own
+        // instead of the outline running through the corner twice.
+        unsigned available = builder->edges[vertex];
+        int left = (direction + 1) & 3;
+        int right = (direction + 3) & 3;
+        if (available & (1u << right))
+        {
+            direction = right;
+        }
+        else if (!(available & (1u << direction)))
+        {
+            direction = left;
+        }
+    } while (vertex != start || direction != firstDirection);
+
+    // Only corners become points, which merges runs of collinear edges
+    TileOutlines *outlines = &builder->outlines;
+    TileLoop loop = {outlines->pointCount, 0, region};
+    for (int i = 0; i < count; ++i)
+    {
+        int previous = i > 0 ? i - 1 : count - 1;
+        if (builder->traceDirections[previous] != builder->traceDirections[i])
+        {
+            AddOutlinePoint(builder, builder->traceVertices[i]);
+        }
+    }
+    loop.pointCount = outlines->pointCount - loop.firstPoint;
+
+    if (outlines->loopCount == builder->loopCapacity)
+    {
+        builder->loopCapacity = builder->loopCapacity > 0 ? 2 * builder->loopCapacity : 16;
+        GrowArray((void **)&outlines->loops, builder->loopCapacity, sizeof(TileLoop));
+    }
+    outlines->loops[outlines->loopCount++] = loop;
+}
+
+TileOutlines CompileTileOutlines(const TileLayer *layer)
+{
+    OutlineBuilder builder = {0};
+    builder.layer = layer;
+    builder.vertexStride = layer->width + 1;
+    builder.edges = calloc((size_t)(layer->width + 1) * (size_t)(layer->height + 1), 1);
+    builder.visited = calloc((size_t)layer->width * (size_t)layer->height, 1);
+
+    int tileCount = layer->width * layer->height;
+    for (int tile = 0; tile < tileCount; ++tile)
+    {
+        if (layer->tiles[tile] == TILE_EMPTY || builder.visited[tile])
+        {
+            continue;
+        }
+
+        int region = builder.outlines.regionCount++;
+        int regionTileCount = FloodRegion(&builder, tile);
+        int startCount = AddRegionEdges(&builder, regionTileCount);
+
+        for (int i = 0; i < startCount; ++i)
+        {
+            // Reread after each loop, which may also have taken the other edge of a corner
+            int vertex = builder.starts[i];
+            for (int direction = 0; direction < 4; ++direction)
+            {
+                unsigned edges = builder.edges[vertex];
+                unsigned untraced = edges & ~(edges >> EDGE_TRACED_SHIFT) & EDGE_MASK;
+                if (untraced & (1u << direction))
+                {
+                    TraceLoop(&builder, vertex, direction, region);
+                }
+            }
+        }
+
+        // Regions touching at a corner share vertices, so clear the edges before the next one
+        for (int i = 0; i < startCount; ++i)
+        {
+            builder.edges[builder.starts[i]] = 0;
+        }
+    }
+
+    free(builder.edges);
+    free(builder.visited);
+    free(builder.cells);
+    free(builder.stack);
+    free(builder.starts);
+    free(builder.traceVertices);
+    free(builder.traceDirections);
+    return builder.outlines;
+}
+
+void FreeTileOutlines(TileOutlines *outlines)
+{
+    free(outlines->points);
+    free(outlines->loops);
+    *outlines = (TileOutlines){0};
+}
+
+TileColliders CreateTileColliders(b2WorldId worldId,
+                                  const TileLayer *layer,
+                                  const TileOutlines *outlines,
+                                  const b2ChainDef *chainDef)
+{
+    TileColliders colliders = {0};
+    colliders.bodyCount = outlines->regionCount;
+    colliders.bodies = malloc(sizeof(b2BodyId) * (size_t)(outlines->regionCount + 1));
+
+    for (int i = 0; i < outlines->regionCount; ++i)
+    {
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.position = layer->origin;
+        colliders.bodies[i] = b2CreateBody(worldId, &bodyDef);
+    }
+
+    for (int i = 0; i < outlines->loopCount; ++i)
+    {
+        const TileLoop *loop = outlines->loops + i;
+        b2ChainDef def = *chainDef;
+        def.points = outlines->points + loop->firstPoint;
+        def.count = loop->pointCount;
+        def.loop = true;
+        b2CreateChain(colliders.bodies[loop->region], &def);
+
+        colliders.chainCount += 1;
+        colliders.segmentCount += loop->pointCount;
+    }
+
+    return colliders;
+}
+
+void DestroyTileColliders(TileColliders *colliders)
+{
+    for (int i = 0; i < colliders->bodyCount; ++i)
+    {
+        b2DestroyBody(colliders->bodies[i]);
+    }
+
+    free(colliders->bodies);
+    *colliders = (TileColliders){0};
+}
+
+static void ReserveTileSprites(TileSprites *sprites, int capacity)
+{
+    if (capacity <= sprites->capacity)
+    {
+        return;
+    }
+
+    GrowArray((void **)&sprites->positionX, capacity, sizeof(float));
+    GrowArray((void **)&sprites->positionY, capacity, sizeof(float));
+    GrowArray((void **)&sprites->rotationC, capacity, sizeof(float));
+    GrowArray((void **)&sprites->rotationS, capacity, sizeof(float));
+    GrowArray((void **)&sprites->spriteIds, capacity, sizeof(int));
+    sprites->capacity = capacity;
+}
+
+void GatherTileSprites(const TileLayer *layer, b2AABB view, TileSprites *sprites)
+{
+    sprites->count = 0;
+
+    float tileSize = layer->tileSize;
+    int minX = (int)floorf((view.lowerBound.x - layer->origin.x) / tileSize);
+    int minY = (int)floorf((view.lowerBound.y - layer->origin.y) / tileSize);
+    int maxX = (int)floorf((view.upperBound.x - layer->origin.x) / tileSize);
+    int maxY = (int)floorf((view.upperBound.y - layer->origin.y) / tileSize);
+    minX = minX > 0 ? minX : 0;
+    minY = minY > 0 ? minY : 0;
+    maxX = maxX < layer->width - 1 ? maxX : layer->width - 1;
+    maxY = maxY < layer->height - 1 ? maxY : layer->height - 1;
+    if (minX > maxX || minY > maxY)
+    {
+        return;
+    }
+
+    ReserveTileSprites(sprites, (maxX - minX + 1) * (maxY - minY + 1));
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            int spriteId = layer->tiles[y * layer->width + x];
+            if (spriteId == TILE_EMPTY)
+            {
+                continue;
+            }
+
+            int i = sprites->count++;
+            sprites->positionX[i] = layer->origin.x + ((float)x + 0.5f) * tileSize;
+            sprites->positionY[i] = layer->origin.y + ((float)y + 0.5f) * tileSize;
+            sprites->rotationC[i] = 1.0f;
+            sprites->rotationS[i] = 0.0f;
+            sprites->spriteIds[i] = spriteId;
+        }
+    }
+}
+
+void FreeTileSprites(TileSprites *sprites)
+{
+    free(sprites->positionX);
+    free(sprites->positionY);
+    free(sprites->rotationC);
+    free(sprites->rotationS);
+    free(sprites->spriteIds);
+    *sprites = (TileSprites){0};
+}
@@ -0,0 +1,95 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "box2d/box2d.h"
+
+#include <stdbool.h>
+
+// Static tile layers. Instead of a body and a box shape per tile, the layer is compiled into the
+// outlines of its solid regions and each region becomes one static body with a looped chain per
+// outline. A flat floor of any length then costs four chain segments in the broadphase rather than
+// one proxy per tile, and boxes sliding across it no longer catch on the seams between tiles.
+// The tiles themselves stay in the layer for rendering.
+
+#define TILE_EMPTY (-1)
+
+// Grid of tiles with row 0 at the bottom. A tile is its sprite id, or TILE_EMPTY. Every non-empty
+// tile is solid.
+typedef struct TileLayer
+{
+    int *tiles; // width * height entries, row-major
+    int width;
+    int height;
+    b2Vec2 origin; // lower left corner of tile (0, 0)
+    float tileSize;
+} TileLayer;
+
+// One closed outline, points [firstPoint, firstPoint + pointCount)
+typedef struct TileLoop
+{
+    int firstPoint;
+    int pointCount;
+    int region;
+} TileLoop;
+
+// Outlines of the 4-connected solid regions of a layer. Loops keep the solid tiles on their left,
+// so outer boundaries run counter-clockwise and holes clockwise, which is the winding Box2D chains
+// need to collide on the outside of the solid. Collinear edges are merged. Where two tiles of a
+// region only touch at a corner the outline is split there, so every loop is a simple polygon.
+// Regions are 4-connected, so tiles touching only at a corner are in the same region when they are
+// connected some other way and in different regions otherwise.
+typedef struct TileOutlines
+{
+    b2Vec2 *points; // relative to the layer origin
+    int pointCount;
+    TileLoop *loops; // grouped by region, regions in the order of their lowest tile
+    int loopCount;
+    int regionCount;
+} TileOutlines;
+
+typedef struct TileColliders
+{
+    b2BodyId *bodies; // one per region
+    int bodyCount;
+    int chainCount;
+    int segmentCount; // broadphase proxies, one per chain segment
+} TileColliders;
+
+// Visible tiles, laid out to be passed to BuildSpriteBatch as SpriteInstances
+typedef struct TileSprites
+{
+    float *positionX;
+    float *positionY;
+    float *rotationC;
+    float *rotationS;
+    int *spriteIds;
+    int count;
+    int capacity;
+} TileSprites;
+
+// All tiles start out empty
+TileLayer CreateTileLayer(int width, int height, b2Vec2 origin, float tileSize);
+void DestroyTileLayer(TileLayer *layer);
+
+// Tiles outside the layer are empty
+bool IsTileSolid(const TileLayer *layer, int x, int y);
+
+TileOutlines CompileTileOutlines(const TileLayer *layer);
+void FreeTileOutlines(TileOutlines *outlines);
+
+// Creates one static body per region at the layer origin with a looped chain for each of its
+// outlines. chainDef supplies the surface properties and filter; points, count and loop are set
+// here.
+TileColliders CreateTileColliders(b2WorldId worldId,
+                                  const TileLayer *layer,
+                                  const TileOutlines *outlines,
+                                  const b2ChainDef *chainDef);
+
+// Destroys the bodies and with them their chains
+void DestroyTileColliders(TileColliders *colliders);
+
+// Replaces the contents of sprites with the solid tiles overlapping view
+void GatherTileSprites(const TileLayer *layer, b2AABB view, TileSprites *sprites);
+void FreeTileSprites(TileSprites *sprites);
+
+#endif // TILEMAP_H
@@ -0,0 +1,27 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+// Monotonic clock in nanoseconds. Only differences between two readings are meaningful.
+uint64_t TimerNow(void);
+
+// Seconds elapsed between two TimerNow() readings
+double TimerSeconds(uint64_t start, uint64_t end);
+
+// Blocks the calling thread for at least the given time. The OS may oversleep by its scheduler
+// granularity, up to several milliseconds on some platforms.
+void TimerSleep(uint64_t nanoseconds);
+
+// Shortest wait worth sleeping for. Shorter waits are better spun, as even high resolution timers
+// on Windows do not wake up sooner than about half a millisecond.
+#if defined(_WIN32)
+#define TIMER_MIN_SLEEP_NANOSECONDS 500000ull
+#else
+#define TIMER_MIN_SLEEP_NANOSECONDS 50000ull
+#endif
+
+// CPU time consumed by all threads of the process, in seconds
+double TimerProcessCpuSeconds(void);
+
+#endif // TIMER_H
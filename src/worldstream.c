@@ -0,0 +1,322 @@
+#include "worldstream.h"
+#include "timer.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct Chunk
+{
+    // Generated when the chunk is first wanted, released once it is fully destroyed
+    ChunkBody *bodies;
+    EntityHandle *entities;
+    int bodyCount;
+    int createdCount; // bodies [0, createdCount) exist in the world
+    bool wanted;
+    bool active;
+} Chunk;
+
+struct WorldStream
+{
+    WorldStreamDef def;
+    b2WorldId worldId;
+    EntityStore *entities;
+    b2Polygon tilePolygon;
+
+    Chunk *chunks;
+    int *activeChunks; // chunks that are wanted or still have bodies
+    int activeCount;
+    b2Vec2 focus;
+
+    WorldStreamStats stats;
+    double updateHistory[WORLD_STREAM_STATS_WINDOW];
+    int updateCount;
+};
+
+WorldStreamDef DefaultWorldStreamDef(void)
+{
+    WorldStreamDef def = {0};
+    def.maxChunkBodies = 256;
+    def.chunkSize = 16.0f;
+    def.chunkCountX = 1;
+    def.chunkCountY = 1;
+    def.tileSize = 1.0f;
+    def.loadRadius = 24.0f;
+    def.unloadRadius = 32.0f;
+    def.budgetSeconds = 0.001;
+    return def;
+}
+
+WorldStream *CreateWorldStream(b2WorldId worldId, EntityStore *entities, const WorldStreamDef *def)
+{
+    WorldStream *stream = calloc(1, sizeof(WorldStream));
+    stream->def = *def;
+    stream->worldId = worldId;
+    stream->entities = entities;
+    stream->tilePolygon = b2MakeSquare(0.5f * def->tileSize);
+
+    int chunkCount = def->chunkCountX * def->chunkCountY;
+    stream->chunks = calloc((size_t)chunkCount, sizeof(Chunk));
+    stream->activeChunks = malloc(sizeof(int) * (size_t)chunkCount);
+    return stream;
+}
+
+// Distance from the focus point to the nearest point of the chunk
+static float GetChunkDistance(const WorldStream *stream, int chunkIndex)
+{
+    const WorldStreamDef *def = &stream->def;
+    float minX = def->origin.x + (float)(chunkIndex % def->chunkCountX) * def->chunkSize;
+    float minY = def->origin.y + (float)(chunkIndex / def->chunkCountX) * def->chunkSize;
+    float dx = fmaxf(fmaxf(minX - stream->focus.x, stream->focus.x - minX - def->chunkSize), 0.0f);
+    float dy = fmaxf(fmaxf(minY - stream->focus.y, stream->focus.y - minY - def->chunkSize), 0.0f);
+    return sqrtf(dx * dx + dy * dy);
+}
+
+static void WantChunk(WorldStream *stream, int chunkIndex)
+{
+    Chunk *chunk = stream->chunks + chunkIndex;
+    chunk->wanted = true;
+
+    if (chunk->bodies == NULL)
+    {
+        const WorldStreamDef *def = &stream->def;
+        chunk->bodies = malloc(sizeof(ChunkBody) * (size_t)def->maxChunkBodies);
+        chunk->bodyCount = def->generator(chunkIndex % def->chunkCountX,
+                                          chunkIndex / def->chunkCountX,
+                                          chunk->bodies,
+                                          def->maxChunkBodies,
+                                          def->generatorContext);
+        chunk->entities = malloc(sizeof(EntityHandle) * (size_t)(chunk->bodyCount + 1));
+    }
+
+    if (!chunk->active)
+    {
+        chunk->active = true;
+        stream->activeChunks[stream->activeCount++] = chunkIndex;
+    }
+}
+
+static void CreateNextBody(WorldStream *stream, Chunk *chunk)
+{
+    const ChunkBody *source = chunk->bodies + chunk->createdCount;
+
+    b2BodyDef bodyDef = b2DefaultBodyDef();
+    bodyDef.type = source->dynamic ? b2_dynamicBody : b2_staticBody;
+    bodyDef.position = source->position;
+    bodyDef.angle = source->angle;
+    b2BodyId bodyId = b2CreateBody(stream->worldId, &bodyDef);
+
+    b2ShapeDef shapeDef = b2DefaultShapeDef();
+    shapeDef.restitution = source->dynamic ? 0.1f : shapeDef.restitution;
+    b2CreatePolygonShape(bodyId, &shapeDef, &stream->tilePolygon);
+
+    // The invalid handle is still recorded so destroying the chunk stays in step with its bodies
+    EntityHandle handle = CreateEntity(stream->entities, bodyId, source->spriteId);
+    if (!IsEntityValid(stream->entities, handle))
+    {
+        b2DestroyBody(bodyId);
+    }
+
+    chunk->entities[chunk->createdCount++] = handle;
+    stream->stats.createdBodyCount += 1;
+}
+
+static void DestroyLastBody(WorldStream *stream, Chunk *chunk)
+{
+    EntityHandle handle = chunk->entities[--chunk->createdCount];
+    int index = GetEntityIndex(stream->entities, handle);
+    if (index >= 0)
+    {
+        b2BodyId bodyId = stream->entities->bodyIds[index];
+        DestroyEntity(stream->entities, handle);
+        b2DestroyBody(bodyId);
+    }
+
+    stream->stats.destroyedBodyCount += 1;
+}
+
+static bool HasWork(const Chunk *chunk)
+{
+    return chunk->wanted ? chunk->createdCount < chunk->bodyCount : chunk->createdCount > 0;
+}
+
+// Unwanted chunks first since destroying frees memory and is cheap, then the nearest wanted chunk
+static int PickChunk(const WorldStream *stream)
+{
+    int best = -1;
+    float bestDistance = FLT_MAX;
+    for (int i = 0; i < stream->activeCount; ++i)
+    {
+        const Chunk *chunk = stream->chunks + stream->activeChunks[i];
+        if (!HasWork(chunk))
+        {
+            continue;
+        }
+
+        if (!chunk->wanted)
+        {
+            return i;
+        }
+
+        float distance = GetChunkDistance(stream, stream->activeChunks[i]);
+        if (distance < bestDistance)
+        {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+
+    return best;
+}
+
+static void ReleaseChunk(WorldStream *stream, int activeIndex)
+{
+    Chunk *chunk = stream->chunks + stream->activeChunks[activeIndex];
+    free(chunk->bodies);
+    free(chunk->entities);
+    *chunk = (Chunk){0};
+    stream->activeChunks[activeIndex] = stream->activeChunks[--stream->activeCount];
+}
+
+// Marks chunks inside the load radius as wanted and those outside the unload radius as unwanted
+static void UpdateWantedChunks(WorldStream *stream)
+{
+    const WorldStreamDef *def = &stream->def;
+    float radius = def->loadRadius;
+    int minX = (int)floorf((stream->focus.x - radius - def->origin.x) / def->chunkSize);
+    int maxX = (int)floorf((stream->focus.x + radius - def->origin.x) / def->chunkSize);
+    int minY = (int)floorf((stream->focus.y - radius - def->origin.y) / def->chunkSize);
+    int maxY = (int)floorf((stream->focus.y + radius - def->origin.y) / def->chunkSize);
+    minX = minX > 0 ? minX : 0;
+    minY = minY > 0 ? minY : 0;
+    maxX = maxX < def->chunkCountX - 1 ? maxX : def->chunkCountX - 1;
+    maxY = maxY < def->chunkCountY - 1 ? maxY : def->chunkCountY - 1;
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            int chunkIndex = y * def->chunkCountX + x;
+            if (!stream->chunks[chunkIndex].wanted &&
+                GetChunkDistance(stream, chunkIndex) <= def->loadRadius)
+            {
+                WantChunk(stream, chunkIndex);
+            }
+        }
+    }
+
+    for (int i = 0; i < stream->activeCount; ++i)
+    {
+        int chunkIndex = stream->activeChunks[i];
+        Chunk *chunk = stream->chunks + chunkIndex;
+        if (chunk->wanted && GetChunkDistance(stream, chunkIndex) > def->unloadRadius)
+        {
+            chunk->wanted = false;
+        }
+
+        // Left before any of its bodies were created
+        if (!chunk->wanted && chunk->createdCount == 0)
+        {
+            ReleaseChunk(stream, i--);
+        }
+    }
+}
+
+static void RunWorldStream(WorldStream *stream, b2Vec2 focus, uint64_t budget)
+{
+    uint64_t start = TimerNow();
+
+    stream->focus = focus;
+    stream->stats.createdBodyCount = 0;
+    stream->stats.destroyedBodyCount = 0;
+    UpdateWantedChunks(stream);
+
+    bool outOfTime = false;
+    while (!outOfTime)
+    {
+        int activeIndex = PickChunk(stream);
+        if (activeIndex < 0)
+        {
+            break;
+        }
+
+        Chunk *chunk = stream->chunks + stream->activeChunks[activeIndex];
+        while (HasWork(chunk) && !outOfTime)
+        {
+            if (chunk->wanted)
+            {
+                CreateNextBody(stream, chunk);
+            }
+            else
+            {
+                DestroyLastBody(stream, chunk);
+            }
+
+            outOfTime = TimerNow() - start >= budget;
+        }
+
+        if (!chunk->wanted && chunk->createdCount == 0)
+        {
+            ReleaseChunk(stream, activeIndex);
+        }
+    }
+
+    // Statistics
+    WorldStreamStats *stats = &stream->stats;
+    stats->liveBodyCount = 0;
+    stats->loadedChunkCount = 0;
+    stats->pendingChunkCount = 0;
+    for (int i = 0; i < stream->activeCount; ++i)
+    {
+        const Chunk *chunk = stream->chunks + stream->activeChunks[i];
+        stats->liveBodyCount += chunk->createdCount;
+        stats->loadedChunkCount += chunk->wanted && !HasWork(chunk) ? 1 : 0;
+        stats->pendingChunkCount += HasWork(chunk) ? 1 : 0;
+    }
+
+    stats->updateMs = 1000.0 * TimerSeconds(start, TimerNow());
+    stream->updateHistory[stream->updateCount++ % WORLD_STREAM_STATS_WINDOW] = stats->updateMs;
+
+    int historyCount = stream->updateCount < WORLD_STREAM_STATS_WINDOW ? stream->updateCount
+                                                                       : WORLD_STREAM_STATS_WINDOW;
+    stats->maxUpdateMs = 0.0;
+    for (int i = 0; i < historyCount; ++i)
+    {
+        stats->maxUpdateMs = fmax(stats->maxUpdateMs, stream->updateHistory[i]);
+    }
+}
+
+void UpdateWorldStream(WorldStream *stream, b2Vec2 focus)
+{
+    RunWorldStream(stream, focus, (uint64_t)(stream->def.budgetSeconds * 1e9));
+}
+
+void FlushWorldStream(WorldStream *stream, b2Vec2 focus)
+{
+    RunWorldStream(stream, focus, UINT64_MAX);
+}
+
+WorldStreamStats GetWorldStreamStats(const WorldStream *stream)
+{
+    return stream->stats;
+}
+
+void DestroyWorldStream(WorldStream *stream)
+{
+    for (int i = 0; i < stream->activeCount; ++i)
+    {
+        Chunk *chunk = stream->chunks + stream->activeChunks[i];
+        while (chunk->createdCount > 0)
+        {
+            DestroyLastBody(stream, chunk);
+        }
+
+        free(chunk->bodies);
+        free(chunk->entities);
+    }
+
+    free(stream->chunks);
+    free(stream->activeChunks);
+    free(stream);
+}
@@ -0,0 +1,84 @@
+#ifndef WORLDSTREAM_H
+#define WORLDSTREAM_H
+
+#include "box2d/box2d.h"
+#include "entities.h"
+
+#include <stdbool.h>
+
+// Splits a level into a grid of square chunks and keeps Box2D bodies only for the chunks around a
+// focus point, usually the camera. Chunks entering the load radius are queued for creation and
+// chunks leaving the unload radius for destruction. The queue is worked off a body at a time under
+// a time budget, so a large chunk is spread over several updates instead of hitching one.
+//
+// Chunk contents come from a generator and are recreated from scratch every time a chunk streams
+// in. Dynamic bodies belong to the chunk that created them, wherever they have moved since.
+
+// One tile-sized box to create when a chunk streams in
+typedef struct ChunkBody
+{
+    b2Vec2 position;
+    float angle;
+    bool dynamic;
+    int spriteId;
+} ChunkBody;
+
+// Writes up to capacity bodies for the chunk and returns how many were written. Must be
+// deterministic. Bodies are created in the order written and destroyed in reverse, so ground
+// should come before whatever rests on it.
+typedef int ChunkGenerator(int chunkX, int chunkY, ChunkBody *bodies, int capacity, void *context);
+
+typedef struct WorldStreamDef
+{
+    ChunkGenerator *generator;
+    void *generatorContext;
+    int maxChunkBodies; // capacity handed to the generator
+
+    b2Vec2 origin;   // lower left corner of chunk (0, 0)
+    float chunkSize; // chunk width and height in world units
+    int chunkCountX;
+    int chunkCountY;
+    float tileSize; // box size of the created bodies
+
+    // Distances from the focus point to the nearest edge of a chunk. The unload radius should be
+    // larger so chunks on the boundary do not stream in and out every update.
+    float loadRadius;
+    float unloadRadius;
+
+    double budgetSeconds; // body creation and destruction time allowed per update
+} WorldStreamDef;
+
+typedef struct WorldStreamStats
+{
+    int liveBodyCount;
+    int loadedChunkCount;  // chunks with all of their bodies created
+    int pendingChunkCount; // chunks with bodies left to create or destroy
+    int createdBodyCount;  // during the last update
+    int destroyedBodyCount;
+    double updateMs;    // time spent in the last update
+    double maxUpdateMs; // slowest of the last WORLD_STREAM_STATS_WINDOW updates
+} WorldStreamStats;
+
+#define WORLD_STREAM_STATS_WINDOW 64
+
+typedef struct WorldStream WorldStream;
+
+WorldStreamDef DefaultWorldStreamDef(void);
+
+// Bodies are created in worldId and registered in entities
+WorldStream *CreateWorldStream(b2WorldId worldId, EntityStore *entities, const WorldStreamDef *def);
+
+// Destroys the bodies and entities of every chunk that is still loaded
+void DestroyWorldStream(WorldStream *stream);
+
+// Moves the focus point, then creates and destroys bodies until the budget is spent. Destruction
+// goes first, then the nearest chunks are created. At least one body is processed per call so
+// streaming always makes progress.
+void UpdateWorldStream(WorldStream *stream, b2Vec2 focus);
+
+// Like UpdateWorldStream but ignores the budget, for the initial load
+void FlushWorldStream(WorldStream *stream, b2Vec2 focus);
+
+WorldStreamStats GetWorldStreamStats(const WorldStream *stream);
+
+#endif // WORLDSTREAM_H
@@ -0,0 +1,357 @@
+// Packs images into an asset archive (see src/assetpack.h). Images are decoded once here, shelf
+// packed into RGBA8 atlas pages and written with their sprite rectangles, so the game maps the
+// result instead of decoding image files at startup.
+//
+//    raylib_template_cooker <output.pak> [--page-size 2048] [--padding 1] <image>...
+
+#include "assetpack.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct CookedSprite
+{
+    AssetSpriteInfo info;
+    unsigned char *pixels;
+} CookedSprite;
+
+typedef struct CookedPage
+{
+    AssetPageInfo info;
+    unsigned char *pixels;
+} CookedPage;
+
+static int CompareSpriteHeights(const void *a, const void *b)
+{
+    const CookedSprite *sa = a;
+    const CookedSprite *sb = b;
+    if (sa->info.height != sb->info.height)
+    {
+        return sa->info.height < sb->info.height ? 1 : -1;
+    }
+
+    return strcmp(sa->info.name, sb->info.name);
+}
+
+static uint32_t NextPowerOfTwo(uint32_t value)
+{
+    uint32_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+static bool GetSpriteName(const char *path, char *name)
+{
+    const char *start = path;
+    for (const char *c = path; *c != '\0'; ++c)
+    {
+        if (*c == '/' || *c == '\\')
+        {
+            start = c + 1;
+        }
+    }
+
+    const char *end = strrchr(start, '.');
+    size_t length = end != NULL ? (size_t)(end - start) : strlen(start);
+    if (length == 0 || length >= ASSET_NAME_LENGTH)
+    {
+        return false;
+    }
+
+    memcpy(name, start, length);
+    name[length] = '\0';
+    return true;
+}
+
+// Copies a sprite into its page and repeats its border pixels into the padding around it, so
+// filtering at the sprite edge does not pick up its neighbours
+static void BlitSprite(CookedPage *page, const CookedSprite *sprite, int padding)
+{
+    int pageWidth = (int)page->info.width;
+    int width = (int)sprite->info.width;
+    int height = (int)sprite->info.height;
+    for (int y = -padding; y < height + padding; ++y)
+    {
+        int sy = y < 0 ? 0 : (y >= height ? height - 1 : y);
+        for (int x = -padding; x < width + padding; ++x)
+        {
+            int sx = x < 0 ? 0 : (x >= width ? width - 1 : x);
+            size_t targetX = (size_t)((int)sprite->info.x + x);
+            size_t targetY = (size_t)((int)sprite->info.y + y);
+            size_t target = (targetY * (size_t)pageWidth + targetX) * 4;
+            memcpy(page->pixels + target, sprite->pixels + ((size_t)sy * width + sx) * 4, 4);
+        }
+    }
+}
+
+// Places sprites, tallest first, left to right in rows. Rows are limited to roughly the square
+// root of the total area so pages come out close to square. Returns the number of pages used.
+static int PackSprites(CookedSprite *sprites,
+                       int spriteCount,
+                       int pageSize,
+                       int padding,
+                       CookedPage *pages)
+{
+    qsort(sprites, (size_t)spriteCount, sizeof(CookedSprite), CompareSpriteHeights);
+
+    double area = 0.0;
+    uint32_t rowLimit = 1;
+    for (int i = 0; i < spriteCount; ++i)
+    {
+        uint32_t cellWidth = sprites[i].info.width + 2 * (uint32_t)padding;
+        uint32_t cellHeight = sprites[i].info.height + 2 * (uint32_t)padding;
+        area += (double)cellWidth * cellHeight;
+        rowLimit = cellWidth > rowLimit ? cellWidth : rowLimit;
+    }
+
+    uint32_t squareWidth = 1;
+    while ((double)squareWidth * squareWidth < area)
+    {
+        squareWidth <<= 1;
+    }
+
+    rowLimit = NextPowerOfTwo(squareWidth > rowLimit ? squareWidth : rowLimit);
+    rowLimit = rowLimit < (uint32_t)pageSize ? rowLimit : (uint32_t)pageSize;
+
+    int pageCount = 0;
+    int first = 0;
+    while (first < spriteCount)
+    {
+        uint32_t cursorX = 0;
+        uint32_t cursorY = 0;
+        uint32_t rowHeight = 0;
+        uint32_t usedWidth = 0;
+        int last = first;
+        for (; last < spriteCount; ++last)
+        {
+            AssetSpriteInfo *info = &sprites[last].info;
+            uint32_t cellWidth = info->width + 2 * (uint32_t)padding;
+            uint32_t cellHeight = info->height + 2 * (uint32_t)padding;
+            if (cursorX + cellWidth > rowLimit)
+            {
+                cursorX = 0;
+                cursorY += rowHeight;
+                rowHeight = 0;
+            }
+
+            if (cursorY + cellHeight > (uint32_t)pageSize)
+            {
+                break;
+            }
+
+            info->page = (uint32_t)pageCount;
+            info->x = cursorX + (uint32_t)padding;
+            info->y = cursorY + (uint32_t)padding;
+            cursorX += cellWidth;
+            rowHeight = cellHeight > rowHeight ? cellHeight : rowHeight;
+            usedWidth = cursorX > usedWidth ? cursorX : usedWidth;
+        }
+
+        // Trim the page to the packed area
+        CookedPage *page = pages + pageCount;
+        page->info.width = NextPowerOfTwo(usedWidth);
+        page->info.height = NextPowerOfTwo(cursorY + rowHeight);
+        page->info.format = ASSET_PIXEL_RGBA8;
+        page->info.dataSize = (uint64_t)page->info.width * page->info.height * 4;
+        page->pixels = calloc(1, (size_t)page->info.dataSize);
+
+        for (int i = first; i < last; ++i)
+        {
+            AssetSpriteInfo *info = &sprites[i].info;
+            info->u0 = (float)info->x / (float)page->info.width;
+            info->v0 = (float)info->y / (float)page->info.height;
+            info->u1 = (float)(info->x + info->width) / (float)page->info.width;
+            info->v1 = (float)(info->y + info->height) / (float)page->info.height;
+            BlitSprite(page, sprites + i, padding);
+        }
+
+        first = last;
+        pageCount += 1;
+    }
+
+    return pageCount;
+}
+
+static uint64_t AlignOffset(uint64_t offset)
+{
+    return (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
+
+static bool WritePack(const char *path,
+                      const CookedSprite *sprites,
+                      int spriteCount,
+                      CookedPage *pages,
+                      int pageCount)
+{
+    uint64_t offset = sizeof(AssetPackHeader) + (uint64_t)pageCount * sizeof(AssetPageInfo) +
+                      (uint64_t)spriteCount * sizeof(AssetSpriteInfo);
+    for (int i = 0; i < pageCount; ++i)
+    {
+        offset = AlignOffset(offset);
+        pages[i].info.dataOffset = offset;
+        offset += pages[i].info.dataSize;
+    }
+
+    AssetPackHeader header = {ASSET_PACK_MAGIC,
+                              ASSET_PACK_VERSION,
+                              (uint32_t)pageCount,
+                              (uint32_t)spriteCount,
+                              offset};
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; ok && i < pageCount; ++i)
+    {
+        ok = fwrite(&pages[i].info, sizeof(AssetPageInfo), 1, file) == 1;
+    }
+
+    for (int i = 0; ok && i < spriteCount; ++i)
+    {
+        ok = fwrite(&sprites[i].info, sizeof(AssetSpriteInfo), 1, file) == 1;
+    }
+
+    for (int i = 0; ok && i < pageCount; ++i)
+    {
+        static const unsigned char zeros[ASSET_PACK_ALIGNMENT] = {0};
+        long position = ftell(file);
+        size_t paddingSize = (size_t)(pages[i].info.dataOffset - (uint64_t)position);
+        ok = fwrite(zeros, 1, paddingSize, file) == paddingSize &&
+             fwrite(pages[i].pixels, 1, (size_t)pages[i].info.dataSize, file) ==
+                 (size_t)pages[i].info.dataSize;
+    }
+
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr,
+                "usage: %s <output.pak> [--page-size 2048] [--padding 1] <image>...\n",
+                argv[0]);
+        return 1;
+    }
+
+    const char *outputPath = argv[1];
+    int pageSize = 2048;
+    int padding = 1;
+
+    CookedSprite *sprites = calloc((size_t)argc, sizeof(CookedSprite));
+    int spriteCount = 0;
+    bool ok = true;
+    for (int i = 2; i < argc && ok; ++i)
+    {
+        if (strcmp(argv[i], "--page-size") == 0 && i + 1 < argc)
+        {
+            pageSize = atoi(argv[++i]);
+            continue;
+        }
+
+        if (strcmp(argv[i], "--padding") == 0 && i + 1 < argc)
+        {
+            padding = atoi(argv[++i]);
+            continue;
+        }
+
+        CookedSprite *sprite = sprites + spriteCount;
+        if (!GetSpriteName(argv[i], sprite->info.name))
+        {
+            fprintf(stderr,
+                    "%s: name must be 1 to %d characters\n",
+                    argv[i],
+                    ASSET_NAME_LENGTH - 1);
+            ok = false;
+            break;
+        }
+
+        for (int j = 0; j < spriteCount; ++j)
+        {
+            if (strcmp(sprites[j].info.name, sprite->info.name) == 0)
+            {
+                fprintf(stderr, "%s: duplicate sprite name %s\n", argv[i], sprite->info.name);
+                ok = false;
+            }
+        }
+
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        sprite->pixels = ok ? stbi_load(argv[i], &width, &height, &channels, 4) : NULL;
+        if (ok && sprite->pixels == NULL)
+        {
+            fprintf(stderr, "%s: %s\n", argv[i], stbi_failure_reason());
+            ok = false;
+        }
+        else if (ok && (width + 2 * padding > pageSize || height + 2 * padding > pageSize))
+        {
+            fprintf(stderr, "%s: %dx%d does not fit a %d page\n", argv[i], width, height, pageSize);
+            stbi_image_free(sprite->pixels);
+            ok = false;
+        }
+
+        if (ok)
+        {
+            sprite->info.width = (uint32_t)width;
+            sprite->info.height = (uint32_t)height;
+            spriteCount += 1;
+        }
+    }
+
+    if (ok && (pageSize <= 0 || (pageSize & (pageSize - 1)) != 0 || padding < 0))
+    {
+        fprintf(stderr, "--page-size must be a power of two and --padding not negative\n");
+        ok = false;
+    }
+
+    // Every sprite can be alone on its page at worst
+    CookedPage *pages = calloc((size_t)spriteCount + 1, sizeof(CookedPage));
+    int pageCount = 0;
+    if (ok && spriteCount > 0)
+    {
+        pageCount = PackSprites(sprites, spriteCount, pageSize, padding, pages);
+        ok = WritePack(outputPath, sprites, spriteCount, pages, pageCount);
+        if (!ok)
+        {
+            fprintf(stderr, "%s: write failed\n", outputPath);
+        }
+    }
+    else if (ok)
+    {
+        fprintf(stderr, "no images to pack\n");
+        ok = false;
+    }
+
+    if (ok)
+    {
+        printf("Packed %d sprites into %d pages: %s\n", spriteCount, pageCount, outputPath);
+    }
+
+    for (int i = 0; i < pageCount; ++i)
+    {
+        free(pages[i].pixels);
+    }
+
+    for (int i = 0; i < spriteCount; ++i)
+    {
+        stbi_image_free(sprites[i].pixels);
+    }
+
+    free(pages);
+    free(sprites);
+    return ok ? 0 : 1;
+}